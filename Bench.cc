@@ -0,0 +1,99 @@
+// 只有头文件的算法族: 优先队列与图算法, 其余各族在各自.cc的BENCH分支里
+#include "GraphGen.hh"
+#include "SPDikstra.hh"
+#include "Bench.hh"
+#include <optional>
+
+// 插入n个再全部取出
+template <class PQ> void pushPop(Bench &bench, std::string_view name) {
+  struct State {
+    ns::vector<int> A, out;
+  };
+  bench.bulk(
+      "heap", name,
+      [&](int n, Dist d) { return State{benchData(d, n, bench.seed), {}}; },
+      [](State &s) {
+        PQ pq(s.A.size());
+        for (int e : s.A)
+          pq.insert(e);
+        s.out.reserve(s.A.size());
+        while (!pq.empty())
+          s.out.push_back(pq.delMin());
+      },
+      [](State &s) {
+        std::sort(s.A.begin(), s.A.end());
+        return std::ranges::equal(s.A, s.out);
+      });
+}
+
+// 从s出发的最短路, 与参考结果比对
+template <class SP>
+void shortestPath(Bench &bench, std::string_view name, std::string_view input,
+                  const CSR<EdgeWeightedDigraph> &G, int s, const SPT &ref) {
+  if (bench.selected("sp", name))
+    bench.measure(
+        "sp", name, G.E, input, [] { return std::optional<SP>{}; },
+        [&](std::optional<SP> &sp) { sp.emplace(G, s); },
+        [&](std::optional<SP> &sp) {
+          return std::equal(ref.distTo.begin(), ref.distTo.end(),
+                            sp->distTo.begin(), sp->distTo.end());
+        });
+}
+
+// 全部用例, 演示与基准共用
+void benchAll(Bench &bench, const char *name) {
+  pushPop<MinPQ<int>>(bench, "MinPQ");
+  pushPop<DaryMinPQ<int, 4>>(bench, "DaryMinPQ<4>");
+  pushPop<DaryMinPQ<int, 8>>(bench, "DaryMinPQ<8>");
+
+  // 每个输入图只生成一次, 各算法重复跑在同一个CSR上
+  for (int n : bench.sizes)
+    for (std::string_view input : bench.graphs) {
+      auto L{generateByName(input, n, bench.seed, true)};
+      if (!L)
+        Bench::usage(name);
+      CSR<EdgeWeightedDigraph> G{toCSR<EdgeWeightedDigraph>(*L)};
+      // 从出度最大的顶点出发, 避开R-MAT里的孤立点
+      int s{0};
+      for (int v = 0; v < G.V; ++v)
+        if (G.adj[v].size() > G.adj[s].size())
+          s = v;
+      DikstraSP<> ref(G, s);
+      shortestPath<DikstraSP<>>(bench, "DikstraSP<IndexMinPQ>", input, G, s,
+                                ref);
+      shortestPath<DikstraSP<DaryIndexMinPQ<int>>>(
+          bench, "DikstraSP<DaryIndexMinPQ<4>>", input, G, s, ref);
+      shortestPath<DikstraSP<RadixIndexMinPQ<>>>(
+          bench, "DikstraSP<RadixIndexMinPQ>", input, G, s, ref);
+      shortestPath<DeltaSteppingSP>(bench, "DeltaSteppingSP", input, G, s,
+                                    ref);
+
+      auto graph = [&] { return &G; };
+      if (bench.selected("graph", "CSR.reverse"))
+        bench.measure(
+            "graph", "CSR.reverse", G.E, input, graph,
+            [](auto &g) { keep(g->reverse()); }, [](auto &) { return true; });
+      if (bench.selected("graph", "toCSR"))
+        bench.measure(
+            "graph", "toCSR", G.E, input, graph,
+            [&](auto &) { keep(toCSR<EdgeWeightedDigraph>(*L)); },
+            [](auto &) { return true; });
+    }
+}
+
+#ifdef BENCH
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  benchAll(bench, argv[0]);
+}
+#else
+// 小规模把每个用例连同校验跑一遍, 结果不对时以非零退出
+int main(int, char **argv) {
+  char n[]{"--n=100,1e3"}, reps[]{"--reps=2"}, graph[]{"--graph=RMAT,Grid"};
+  char *args[]{argv[0], n, reps, graph};
+  Bench bench(4, args);
+  assert(bench.sizes.size() == 2 && bench.sizes[1] == 1000);
+  assert(bench.reps == 2 && bench.graphs.size() == 2);
+  benchAll(bench, argv[0]);
+}
+#endif
@@ -0,0 +1,409 @@
+#pragma once
+#include "vector.hh"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <print>
+#include <random>
+#include <string_view>
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+/**
+ * 基准测试, 每个.cc在-DBENCH下用它替换演示main
+ *
+ *   make bench-X && ./X.bench.exe --n=1e3,1e6 --dist=random --filter=Quick
+ *
+ * 每个(用例, 规模, 分布)输出一行JSON
+ *   unit    run为整次调用, op为单次操作, batch为64次操作的平均
+ *   pNN_ns  每个unit的延迟分位数, batch的分位数看不到单次操作的尾延迟
+ *   allocs  每个unit的operator new次数与字节数
+ */
+
+// 分配计数, 替换全局operator new, 一个程序只能有一个翻译单元包含本文件
+// 不内联, 否则gcc把内联后的malloc/free与operator new/delete误判为不匹配
+inline std::atomic<long> allocCount{0}, allocBytes{0};
+
+[[gnu::noinline]] void *operator new(std::size_t n) {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(n, std::memory_order_relaxed);
+  if (void *p{std::malloc(n ? n : 1)})
+    return p;
+  throw std::bad_alloc{};
+}
+[[gnu::noinline]] void *operator new(std::size_t n, std::align_val_t a) {
+  allocCount.fetch_add(1, std::memory_order_relaxed);
+  allocBytes.fetch_add(n, std::memory_order_relaxed);
+  auto al{static_cast<std::size_t>(a)};
+  if (void *p{std::aligned_alloc(al, (n + al - 1) / al * al)})
+    return p;
+  throw std::bad_alloc{};
+}
+[[gnu::noinline]] void operator delete(void *p) noexcept { std::free(p); }
+[[gnu::noinline]] void operator delete(void *p, std::size_t) noexcept {
+  std::free(p);
+}
+[[gnu::noinline]] void operator delete(void *p, std::align_val_t) noexcept {
+  std::free(p);
+}
+[[gnu::noinline]] void operator delete(void *p, std::size_t,
+                                       std::align_val_t) noexcept {
+  std::free(p);
+}
+
+// 单次操作计时的时钟, x86上为rdtsc, 前后lfence防止与被测代码乱序
+struct Ticks {
+  static std::uint64_t now() {
+#if defined(__x86_64__)
+    _mm_lfence();
+    std::uint64_t t{__rdtsc()};
+    _mm_lfence();
+    return t;
+#else
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+  }
+  // 对照steady_clock标定一次
+  static double ns() {
+    static double perTick{[] {
+      using clock = std::chrono::steady_clock;
+      auto t0{clock::now()};
+      std::uint64_t c0{now()};
+      while (clock::now() - t0 < std::chrono::milliseconds(20))
+        ;
+      std::uint64_t c1{now()};
+      return std::chrono::duration<double, std::nano>(clock::now() - t0)
+                 .count() /
+             double(c1 - c0);
+    }()};
+    return perTick;
+  }
+  // 空计时区间的最小读数差, 从每个样本中扣除
+  static std::uint64_t overhead() {
+    static std::uint64_t least{[] {
+      std::uint64_t m{~std::uint64_t(0)};
+      for (int i = 0; i < 1000; ++i) {
+        std::uint64_t t0{now()};
+        m = std::min(m, now() - t0);
+      }
+      return m;
+    }()};
+    return least;
+  }
+};
+
+// 阻止编译器删掉结果未被使用的计算
+template <class T> inline void keep(T &&x) {
+  asm volatile("" : : "r"(&x) : "memory");
+}
+
+// 输入分布
+enum class Dist { random, sorted, reversed, fewUnique, nearlySorted };
+inline constexpr std::string_view distNames[]{"random", "sorted", "reversed",
+                                              "fewUnique", "nearlySorted"};
+
+inline ns::vector<int> benchData(Dist d, int n, std::uint64_t seed) {
+  std::mt19937_64 mt(seed);
+  ns::vector<int> A(n);
+  for (int i = 0; i < n; ++i)
+    A[i] = d == Dist::fewUnique ? mt() % 16 : int(mt() >> 33);
+  if (d == Dist::sorted || d == Dist::reversed || d == Dist::nearlySorted)
+    std::sort(A.begin(), A.end());
+  if (d == Dist::reversed)
+    std::reverse(A.begin(), A.end());
+  if (d == Dist::nearlySorted)
+    for (int k = 0; k < n / 100; ++k)
+      std::swap(A[mt() % n], A[mt() % n]);
+  return A;
+}
+
+struct Bench {
+  ns::vector<int> sizes{1 << 10, 1 << 16, 1 << 20};
+  ns::vector<Dist> dists{Dist::random, Dist::sorted, Dist::reversed,
+                         Dist::fewUnique, Dist::nearlySorted};
+  // 图算法的输入, 取代dist
+  ns::vector<std::string_view> graphs{"ErdosRenyi", "RMAT", "Grid"};
+  int reps{11};
+  std::string_view filter;
+  std::uint64_t seed{20240601};
+
+  Bench(int argc, char **argv) {
+    auto number = [](std::string_view s) {
+      double x{0};
+      std::from_chars(s.data(), s.data() + s.size(), x);
+      return long(x);
+    };
+    // 逗号分隔的列表
+    auto each = [](std::string_view s, auto f) {
+      while (!s.empty()) {
+        auto comma{std::min(s.find(','), s.size())};
+        f(s.substr(0, comma));
+        s.remove_prefix(std::min(comma + 1, s.size()));
+      }
+    };
+    for (int i = 1; i < argc; ++i) {
+      std::string_view arg{argv[i]};
+      if (arg.starts_with("--n=")) {
+        sizes = ns::vector<int>();
+        each(arg.substr(4), [&](std::string_view s) {
+          if (long n{number(s)}; n > 0)
+            sizes.push_back(int(n));
+        });
+      } else if (arg.starts_with("--dist=")) {
+        dists = ns::vector<Dist>();
+        each(arg.substr(7), [&](std::string_view s) {
+          auto it{std::find(std::begin(distNames), std::end(distNames), s)};
+          if (it == std::end(distNames))
+            usage(argv[0]);
+          dists.push_back(Dist(it - std::begin(distNames)));
+        });
+      } else if (arg.starts_with("--graph=")) {
+        graphs = ns::vector<std::string_view>();
+        each(arg.substr(8), [&](std::string_view s) { graphs.push_back(s); });
+      } else if (arg.starts_with("--reps="))
+        reps = std::max(1L, number(arg.substr(7)));
+      else if (arg.starts_with("--seed="))
+        seed = number(arg.substr(7));
+      else if (arg.starts_with("--filter="))
+        filter = arg.substr(9);
+      else
+        usage(argv[0]);
+    }
+  }
+
+  [[noreturn]] static void usage(const char *name) {
+    std::print(stderr,
+               "usage: {} [--n=N,...] [--dist=random,sorted,reversed,"
+               "fewUnique,nearlySorted] "
+               "[--graph=ErdosRenyi,RMAT,PowerLaw,Grid] "
+               "[--reps=R] [--seed=S] [--filter=SUBSTR]\n",
+               name);
+    std::exit(2);
+  }
+
+  bool selected(std::string_view family, std::string_view name) const {
+    return filter.empty() || family.find(filter) != family.npos ||
+           name.find(filter) != name.npos;
+  }
+
+  /**
+   * 整次调用计时, 每次重复前setup(n, dist)重新生成输入(不计时)
+   *   run(state)        被测调用
+   *   check(state)      结果校验, 失败则以非零退出
+   *   limit             超过此规模跳过, 用于平方级算法
+   */
+  template <class Setup, class Run, class Check>
+  void bulk(std::string_view family, std::string_view name, Setup setup,
+            Run run, Check check, long limit = 1L << 30) {
+    if (!selected(family, name))
+      return;
+    for (int n : sizes)
+      for (Dist d : dists)
+        if (n <= limit)
+          measure(
+              family, name, n, distNames[int(d)], [&] { return setup(n, d); },
+              run, check);
+  }
+
+  // 一组(规模, 输入)重复reps次, input是输入的名字
+  template <class Setup, class Run, class Check>
+  void measure(std::string_view family, std::string_view name, int n,
+               std::string_view input, Setup setup, Run run, Check check) {
+    ns::vector<double> samples;
+    long allocs{0}, bytes{0};
+    for (int r = 0; r < reps; ++r) {
+      auto state{setup()};
+      long a0{allocCount}, b0{allocBytes};
+      auto t0{std::chrono::steady_clock::now()};
+      run(state);
+      auto t1{std::chrono::steady_clock::now()};
+      allocs += allocCount - a0, bytes += allocBytes - b0;
+      keep(state);
+      samples.push_back(
+          std::chrono::duration<double, std::nano>(t1 - t0).count());
+      if (!check(state)) {
+        std::print(stderr, "{}/{} n={} input={}: wrong result\n", family,
+                   name, n, input);
+        std::exit(1);
+      }
+    }
+    report(family, name, "run", n, input, samples, n, allocs, bytes, reps);
+  }
+
+  /**
+   * 成批操作计时, 每64次操作的平均记一个样本, 计时开销摊薄, 适合看吞吐
+   *   setup(n, dist)    构造被测结构(不计时)
+   *   op(state, i)      第i次操作, i在[0,n)内, 共重复reps遍
+   */
+  template <class Setup, class Op>
+  void each(std::string_view family, std::string_view name, Setup setup,
+            Op op, long limit = 1L << 30) {
+    if (!selected(family, name))
+      return;
+    constexpr int batch{64};
+    for (int n : sizes)
+      for (Dist d : dists) {
+        if (n > limit)
+          continue;
+        auto state{setup(n, d)};
+        ns::vector<double> samples;
+        samples.reserve(reps * ((n + batch - 1) / batch));
+        long a0{allocCount}, b0{allocBytes};
+        for (int r = 0; r < reps; ++r)
+          for (int lo = 0; lo < n; lo += batch) {
+            int hi{std::min(n, lo + batch)};
+            auto t0{std::chrono::steady_clock::now()};
+            for (int i = lo; i < hi; ++i)
+              op(state, i);
+            auto t1{std::chrono::steady_clock::now()};
+            samples.push_back(
+                std::chrono::duration<double, std::nano>(t1 - t0).count() /
+                (hi - lo));
+          }
+        long allocs{allocCount - a0}, bytes{allocBytes - b0};
+        keep(state);
+        report(family, name, "batch", n, distNames[int(d)], samples, 1,
+               allocs, bytes, double(reps) * n);
+      }
+  }
+
+  /**
+   * 单次操作计时, 每次操作记一个样本, 分位数即单次操作的延迟分布
+   *   参数同each; 样本扣除了空计时的开销, 适合看尾延迟
+   */
+  template <class Setup, class Op>
+  void latency(std::string_view family, std::string_view name, Setup setup,
+               Op op, long limit = 1L << 30) {
+    if (!selected(family, name))
+      return;
+    double perTick{Ticks::ns()};
+    std::uint64_t overhead{Ticks::overhead()};
+    for (int n : sizes)
+      for (Dist d : dists) {
+        if (n > limit)
+          continue;
+        auto state{setup(n, d)};
+        ns::vector<double> samples;
+        samples.reserve(reps * n);
+        long a0{allocCount}, b0{allocBytes};
+        for (int r = 0; r < reps; ++r)
+          for (int i = 0; i < n; ++i) {
+            std::uint64_t t0{Ticks::now()};
+            op(state, i);
+            std::uint64_t t{Ticks::now() - t0};
+            samples.push_back((t > overhead ? t - overhead : 0) * perTick);
+          }
+        long allocs{allocCount - a0}, bytes{allocBytes - b0};
+        keep(state);
+        report(family, name, "op", n, distNames[int(d)], samples, 1, allocs,
+               bytes, double(reps) * n);
+      }
+  }
+
+  // bulk的样本是一次调用, each的样本是一批操作的平均, latency的是单次操作
+  static void report(std::string_view family, std::string_view name,
+                     std::string_view unit, int n, std::string_view input,
+                     ns::vector<double> &samples, long opsPerUnit, long allocs,
+                     long bytes, double units) {
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) {
+      return samples[std::min<int>(samples.size() - 1, p * samples.size())];
+    };
+    double median{pct(0.5)};
+    std::print("{{\"family\":\"{}\",\"name\":\"{}\",\"n\":{},\"input\":\"{}\","
+               "\"unit\":\"{}\",\"samples\":{},\"ops_per_sec\":{:.0f},"
+               "\"p50_ns\":{:.1f},\"p90_ns\":{:.1f},\"p99_ns\":{:.1f},"
+               "\"max_ns\":{:.1f},\"allocs\":{:.3f},\"alloc_bytes\":{:.1f}}}\n",
+               family, name, n, input, unit, samples.size(),
+               opsPerUnit * 1e9 / median, median, pct(0.9), pct(0.99),
+               samples.back(), allocs / units, bytes / units);
+  }
+
+  // 常用场景: 排序int数组, 与std::sort的结果比对
+  template <class F>
+  void sort(std::string_view name, F f, long limit = 1L << 30) {
+    struct State {
+      ns::vector<int> A, want;
+    };
+    bulk(
+        "sort", name,
+        [&](int n, Dist d) {
+          State s{benchData(d, n, seed), {}};
+          s.want = s.A;
+          std::sort(s.want.begin(), s.want.end());
+          return s;
+        },
+        [&](State &s) { f(s.A); },
+        [](State &s) { return std::ranges::equal(s.A, s.want); }, limit);
+  }
+
+  // 常用场景: 在有序int数组中查找, 一半查询命中
+  template <class F>
+  void search(std::string_view name, F f, long limit = 1L << 30) {
+    struct State {
+      ns::vector<int> A, queries;
+    };
+    each(
+        "search", name,
+        [&](int n, Dist d) {
+          State s{benchData(d, n, seed), ns::vector<int>(n)};
+          std::sort(s.A.begin(), s.A.end());
+          std::mt19937_64 mt(seed);
+          for (int &q : s.queries)
+            q = mt() % 2 ? s.A[mt() % n] : int(mt() >> 33);
+          return s;
+        },
+        [&](State &s, int i) { keep(f(s.queries[i], s.A)); }, limit);
+  }
+
+  /**
+   * 符号表的insert, search, remove, 键取自dist, 值等于键
+   *   make()  返回std::unique_ptr指向空表, 表需有insert/search/remove
+   */
+  template <class Make>
+  void map(std::string_view name, Make make, long limit = 1L << 30) {
+    struct State {
+      ns::vector<int> keys, probe;
+      decltype(make()) st;
+    };
+    auto build = [&](int n, Dist d, bool fill) {
+      State s{benchData(d, n, seed), {}, make()};
+      s.probe = s.keys;
+      std::shuffle(s.probe.begin(), s.probe.end(), std::mt19937_64(seed));
+      if (fill)
+        for (int k : s.keys)
+          s.st->insert(k, k);
+      return s;
+    };
+    auto found = [](State &s, bool all) {
+      for (int k : s.probe)
+        if (bool(s.st->search(k)) != all)
+          return false;
+      return true;
+    };
+    bulk(
+        "map.insert", name, [&](int n, Dist d) { return build(n, d, false); },
+        [](State &s) {
+          for (int k : s.keys)
+            s.st->insert(k, k);
+        },
+        [&](State &s) { return found(s, true); }, limit);
+    each(
+        "map.search", name, [&](int n, Dist d) { return build(n, d, true); },
+        [](State &s, int i) { keep(s.st->search(s.probe[i])); }, limit);
+    bulk(
+        "map.remove", name, [&](int n, Dist d) { return build(n, d, true); },
+        [](State &s) {
+          for (int k : s.probe)
+            if (s.st->search(k))
+              s.st->remove(k);
+        },
+        [&](State &s) { return found(s, false); }, limit);
+  }
+};
@@ -1,4 +1,4 @@
-#include "Graph.hh"
+#include "CSR.hh"
 
 // 图连通性
 struct CC {
@@ -6,7 +6,9 @@ struct CC {
   ns::deque<int> id;
   int count;
 
-  CC(const Graph &G) : marked(G.V, false), id(G.V), count{0} {
+  template <class T>
+    requires isGraphLike<T, Graph>
+  CC(const T &G) : marked(G.V, false), id(G.V), count{0} {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v]) {
         bfs(G, v);
@@ -14,7 +16,7 @@ struct CC {
       }
   }
 
-  void dfs(const Graph &G, int v) {
+  template <class T> void dfs(const T &G, int v) {
     // 首次发现时标记顶点
     marked[v] = true;
     id[v] = count;
@@ -24,7 +26,7 @@ struct CC {
     }
   }
 
-  void bfs(const Graph &G, int s) {
+  template <class T> void bfs(const T &G, int s) {
     // 首次发现时标记顶点
     marked[s] = true;
     id[s] = count;
@@ -62,7 +64,9 @@ struct Articulation {
   int clock{0};
   ns::deque<int> dTime, low;
   ns::deque<bool> visited, isArticulation;
-  Articulation(const Graph &G)
+  template <class T>
+    requires isGraphLike<T, Graph>
+  Articulation(const T &G)
       : dTime(G.V), low(G.V), visited(G.V, false), isArticulation(G.V, false) {
     for (int v = 0; v < G.V; v++) {
       if (!visited[v])
@@ -70,7 +74,7 @@ struct Articulation {
     }
   }
 
-  void dfs(const Graph &G, int u, int parent) {
+  template <class T> void dfs(const T &G, int u, int parent) {
     int child{0};
     low[u] = dTime[u] = ++clock;
     visited[u] = true;
@@ -106,7 +110,14 @@ int main() {
     printCC(cc, G.V);
     std::print("\n");
 
+    CSR<Graph> csr(G);
+    CC ccsr(csr);
+    assert(cc.count == ccsr.count);
+    for (int i = 0; i < v; i++)
+      assert(cc.id[i] == ccsr.id[i]);
+
     Articulation A(G);
+    Articulation B(csr);
     std::print("vertex\t");
     for (int i = 0; i < v; i++)
       std::print("{}\t", i);
@@ -115,6 +126,8 @@ int main() {
     for (int i = 0; i < v; i++)
       std::print("{}\t", A.isArticulation[i]);
     std::print("\n");
+    for (int i = 0; i < v; i++)
+      assert(A.isArticulation[i] == B.isArticulation[i]);
 
     for (int i = 0; i < v; i++) {
       Graph H(v);
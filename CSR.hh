@@ -0,0 +1,168 @@
+#pragma once
+#include "Graph.hh"
+#include "MappedFile.hh"
+#include <concepts>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 压缩稀疏行
+ * offset[v] ~ offset[v+1]-1 是v的邻接表在target/weight中的下标
+ *
+ *   offset  0   2   3       6
+ *   target [w w|w  |w  w  w|...]
+ */
+
+template <class G>
+#ifdef __cpp_lib_concepts
+  requires isGraphType<G>
+#endif
+struct CSR {
+  static constexpr bool weighted{std::is_same_v<G, EdgeWeightedGraph> or
+                                 std::is_same_v<G, EdgeWeightedDigraph>};
+  static constexpr bool directed{std::is_same_v<G, Digraph> or
+                                 std::is_same_v<G, EdgeWeightedDigraph>};
+  using Item = std::conditional_t<
+      std::is_same_v<G, EdgeWeightedGraph>, Edge,
+      std::conditional_t<std::is_same_v<G, EdgeWeightedDigraph>, DirectedEdge,
+                         int>>;
+
+  // 带权邻接表逐项拼出边
+  struct iterator {
+    const CSR *g;
+    int v, i;
+    Item operator*() const { return {v, g->target[i], g->weight[i]}; }
+    iterator &operator++() {
+      ++i;
+      return *this;
+    }
+    bool operator==(const iterator &rhs) const { return i == rhs.i; }
+    bool operator!=(const iterator &rhs) const { return i != rhs.i; }
+  };
+
+  struct Row {
+    const CSR *g;
+    int v;
+    auto begin() const {
+      if constexpr (weighted)
+        return iterator{g, v, g->offset[v]};
+      else
+        return static_cast<const int *>(g->target + g->offset[v]);
+    }
+    auto end() const {
+      if constexpr (weighted)
+        return iterator{g, v, g->offset[v + 1]};
+      else
+        return static_cast<const int *>(g->target + g->offset[v + 1]);
+    }
+    int size() const { return g->offset[v + 1] - g->offset[v]; }
+    bool empty() const { return size() == 0; }
+  };
+
+  struct Adj {
+    const CSR *g;
+    Row operator[](int v) const {
+      assert(0 <= v && v < g->V);
+      return {g, v};
+    }
+  };
+
+  int V, E;
+  // 自己分配的数组, 建图时经它们写入; 借用只读映射时都为空
+  struct Owned {
+    int *offset, *target, *weight;
+  } own{};
+  // 算法只经这组只读指针访问, 指向own或mapping
+  const int *offset;
+  const int *target;
+  const int *weight;
+  Adj adj;
+  // 非空时数组指向这个只读映射, 不归自己delete
+  MappedFile mapping;
+
+  CSR(int V, int E)
+      : V{V}, E{E},
+        own{new int[V + 1]{}, new int[E], weighted ? new int[E] : nullptr},
+        offset{own.offset}, target{own.target}, weight{own.weight}, adj{this} {}
+
+  CSR(int V, int E, const int *offset, const int *target, const int *weight,
+      MappedFile mapping)
+      : V{V}, E{E}, offset{offset}, target{target}, weight{weight}, adj{this},
+        mapping{std::move(mapping)} {}
+
+  CSR(const G &g) : CSR(g.V, count(g)) {
+    for (int v = 0; v < V; ++v)
+      own.offset[v + 1] = offset[v] + g.adj[v].size();
+    for (int v = 0; v < V; ++v) {
+      int i{offset[v]};
+      for (const auto &e : g.adj[v]) {
+        if constexpr (std::is_same_v<G, EdgeWeightedGraph>)
+          own.target[i] = e.other(v), own.weight[i] = e.weight;
+        else if constexpr (std::is_same_v<G, EdgeWeightedDigraph>)
+          own.target[i] = e.to, own.weight[i] = e.weight;
+        else
+          own.target[i] = e;
+        ++i;
+      }
+    }
+  }
+
+  CSR(const CSR &) = delete;
+  CSR &operator=(const CSR &) = delete;
+  CSR(CSR &&other)
+      : V{other.V}, E{other.E}, own{std::exchange(other.own, {})},
+        offset{std::exchange(other.offset, nullptr)},
+        target{std::exchange(other.target, nullptr)},
+        weight{std::exchange(other.weight, nullptr)}, adj{this},
+        mapping{std::move(other.mapping)} {}
+
+  ~CSR() {
+    delete[] own.offset;
+    delete[] own.target;
+    delete[] own.weight;
+  }
+
+  static int count(const G &g) {
+    int e{0};
+    for (int v = 0; v < g.V; ++v)
+      e += g.adj[v].size();
+    return e;
+  }
+
+  // 计数排序转置
+  CSR reverse() const
+    requires directed
+  {
+    CSR r(V, E);
+    for (int i = 0; i < E; ++i)
+      ++r.own.offset[target[i] + 1];
+    for (int v = 0; v < V; ++v)
+      r.own.offset[v + 1] += r.offset[v];
+    int *next{new int[V]};
+    std::copy(r.offset, r.offset + V, next);
+    for (int v = 0; v < V; ++v)
+      for (int i = offset[v]; i < offset[v + 1]; ++i) {
+        int j{next[target[i]]++};
+        r.own.target[j] = v;
+        if constexpr (weighted)
+          r.own.weight[j] = weight[i];
+      }
+    delete[] next;
+    return r;
+  }
+
+  auto edges() const
+    requires weighted
+  {
+    ns::deque<Item> deck;
+    for (int v = 0; v < V; ++v)
+      for (int i = offset[v]; i < offset[v + 1]; ++i)
+        if (directed || target[i] > v)
+          deck.push_back(Item{v, target[i], weight[i]});
+    return deck;
+  }
+};
+
+// 原邻接表或其CSR形式
+template <class T, class G>
+concept isGraphLike = std::is_same_v<T, G> || std::is_same_v<T, CSR<G>>;
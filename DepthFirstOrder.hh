@@ -1,19 +1,23 @@
 #pragma once
-#include "Graph.hh"
+#include "CSR.hh"
 
 struct DepthFirstOrder {
   ns::deque<bool> marked;
   ns::deque<int> preorder;
   ns::deque<int> postorder;
 
-  DepthFirstOrder(const Digraph &G)
+  template <class T>
+    requires isGraphLike<T, Digraph>
+  DepthFirstOrder(const T &G)
       : marked(G.V, false), preorder(), postorder() {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v])
         dfs(G, v);
   }
 
-  void dfs(const Digraph &G, int v) {
+  template <class T>
+    requires isGraphLike<T, Digraph>
+  void dfs(const T &G, int v) {
     preorder.push_back(v);
     marked[v] = true;
     for (int w : G.adj[v]) {
@@ -23,14 +27,18 @@ struct DepthFirstOrder {
     postorder.push_back(v);
   }
 
-  DepthFirstOrder(const EdgeWeightedDigraph &G)
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedDigraph>
+  DepthFirstOrder(const T &G)
       : marked(G.V, false), preorder(), postorder() {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v])
         dfs(G, v);
   }
 
-  void dfs(const EdgeWeightedDigraph &G, int v) {
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedDigraph>
+  void dfs(const T &G, int v) {
     preorder.push_back(v);
     marked[v] = true;
     for (const auto &e : G.adj[v]) {
@@ -1,9 +1,12 @@
 #pragma once
 #include "deque.hh"
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <print>
 #include <random>
 #include <type_traits>
+#include <unordered_set>
 
 struct Graph {
   int V;
@@ -117,37 +120,32 @@ concept isGraphType = std::is_same_v<T, Graph> || std::is_same_v<T, Digraph> or
                       std::is_same_v<T, EdgeWeightedDigraph>;
 #endif
 template <class T>
-void generateGraph(T &G, int e)
+void generateGraph(T &G, int e, std::uint64_t seed = std::random_device{}())
 #ifdef __cpp_lib_concepts
   requires isGraphType<T>
 #endif
 {
-  std::mt19937 mt(std::random_device{}());
+  assert(2L * e <= long(G.V) * (G.V - 1));
+  std::mt19937 mt(seed);
   std::uniform_int_distribution randV(0, G.V - 1), randE(0, 7);
-  ns::deque<int> a(e), b(e);
+  // 无序点对, 同时排除重边与两点环
+  std::unordered_set<std::uint64_t> seen(2 * e);
   int i{0};
   while (i < e) {
-    a[i] = randV(mt), b[i] = randV(mt);
+    int a{randV(mt)}, b{randV(mt)};
     // 自环
-    if (a[i] == b[i])
+    if (a == b)
       continue;
-    int j{0};
-    for (; j < i; ++j) {
-      // 重边
-      if (a[i] == a[j] && b[i] == b[j])
-        break;
-      // 两点环
-      if (a[i] == b[j] && b[i] == a[j])
-        break;
-    }
-    if (i != j)
+    // 重边, 两点环
+    if (!seen.insert(std::uint64_t(std::min(a, b)) << 32 | std::max(a, b))
+             .second)
       continue;
     if constexpr (std::is_same_v<T, Graph> || std::is_same_v<T, Digraph>)
-      G.addEdge(a[i], b[i]);
+      G.addEdge(a, b);
     else if constexpr (std::is_same_v<T, EdgeWeightedGraph>)
-      G.addEdge({a[i], b[i], randE(mt)});
+      G.addEdge({a, b, randE(mt)});
     else if constexpr (std::is_same_v<T, EdgeWeightedDigraph>)
-      G.addEdge({a[i], b[i], randE(mt)});
+      G.addEdge({a, b, randE(mt)});
     ++i;
   }
 }
@@ -0,0 +1,103 @@
+#include "GraphFile.hh"
+#include "DepthFirstOrder.hh"
+#include "GraphGen.hh"
+#include "SPDikstra.hh"
+#include <filesystem>
+
+template <class G> bool same(const CSR<G> &a, const CSR<G> &b) {
+  if (a.V != b.V || a.E != b.E)
+    return false;
+  bool ok{std::equal(a.offset, a.offset + a.V + 1, b.offset) &&
+          std::equal(a.target, a.target + a.E, b.target)};
+  if constexpr (CSR<G>::weighted)
+    ok = ok && std::equal(a.weight, a.weight + a.E, b.weight);
+  return ok;
+}
+
+template <class G> void roundTrip(const char *path, const EdgeList &L) {
+  G g{toGraph<G>(L)};
+  [[maybe_unused]] bool ok{writeGraph(path, g)};
+  assert(ok);
+  auto loaded{loadGraph<G>(path)};
+  assert(loaded && loaded->mapping);
+  assert(same(CSR<G>(g), *loaded));
+  // 类型不符时拒绝加载
+  if constexpr (std::is_same_v<G, Graph>)
+    assert(!loadGraph<Digraph>(path));
+  else
+    assert(!loadGraph<Graph>(path));
+}
+
+int main() {
+  auto tmp{std::filesystem::temp_directory_path() / "GraphFile.bin"};
+  const char *path{tmp.c_str()};
+  constexpr std::uint64_t seed{20240602};
+  EdgeList U{generateErdosRenyi(2048, 8192, seed)};
+  EdgeList D{generateErdosRenyi(2048, 8192, seed, true)};
+
+  roundTrip<Graph>(path, U);
+  roundTrip<Digraph>(path, D);
+  roundTrip<EdgeWeightedGraph>(path, U);
+  roundTrip<EdgeWeightedDigraph>(path, D);
+
+  // 直接在映射上跑算法
+  Digraph DG{toGraph<Digraph>(D)};
+  [[maybe_unused]] bool ok{writeGraph(path, DG)};
+  assert(ok);
+  {
+    auto mapped{loadGraph<Digraph>(path)};
+    DepthFirstOrder order(DG), morder(*mapped);
+    assert(std::equal(order.postorder.begin(), order.postorder.end(),
+                      morder.postorder.begin(), morder.postorder.end()));
+  }
+  Graph G{toGraph<Graph>(U)};
+  EdgeWeightedDigraph EWD{toGraph<EdgeWeightedDigraph>(D)};
+  ok = writeGraph(path, CSR<EdgeWeightedDigraph>(EWD));
+  assert(ok);
+  {
+    auto mapped{loadGraph<EdgeWeightedDigraph>(path)};
+    DikstraSP DSP(EWD, 0), MDSP(*mapped, 0);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      MDSP.distTo.begin(), MDSP.distTo.end()));
+  }
+
+  // 空图
+  ok = writeGraph(path, Digraph(0));
+  assert(ok);
+  assert(loadGraph<Digraph>(path)->V == 0);
+
+  // 截断或版本不符
+  std::filesystem::resize_file(tmp, std::filesystem::file_size(tmp) - 4);
+  assert(!loadGraph<Digraph>(path));
+  ok = writeGraph(path, G);
+  assert(ok);
+  std::filesystem::resize_file(tmp, 100);
+  assert(!loadGraph<Graph>(path));
+  ok = writeGraph(path, G);
+  assert(ok);
+  if (std::FILE *f{std::fopen(path, "r+b")}) {
+    std::uint32_t version{GraphFileHeader::VERSION + 1};
+    std::fseek(f, offsetof(GraphFileHeader, version), SEEK_SET);
+    std::fwrite(&version, sizeof version, 1, f);
+    std::fclose(f);
+  }
+  assert(!loadGraph<Graph>(path));
+
+  // target越界, offset中间递减
+  auto corrupt = [&](auto field, long index, int value) {
+    [[maybe_unused]] bool ok{writeGraph(path, G)};
+    assert(ok && loadGraph<Graph>(path));
+    GraphFileHeader h{makeHeader<Graph>(G.V, CSR<Graph>::count(G))};
+    if (std::FILE *f{std::fopen(path, "r+b")}) {
+      std::fseek(f, h.*field + sizeof(int) * index, SEEK_SET);
+      std::fwrite(&value, sizeof value, 1, f);
+      std::fclose(f);
+    }
+    assert(!loadGraph<Graph>(path));
+  };
+  corrupt(&GraphFileHeader::targetAt, 5, G.V);
+  corrupt(&GraphFileHeader::targetAt, 0, -1);
+  corrupt(&GraphFileHeader::offsetAt, 1, CSR<Graph>::count(G));
+  assert(!loadGraph<Graph>("/nonexistent/GraphFile.bin"));
+  std::filesystem::remove(tmp);
+}
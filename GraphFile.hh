@@ -0,0 +1,107 @@
+#pragma once
+#include "CSR.hh"
+#include "MappedFile.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+/**
+ * 二进制图文件, 本机字节序, 各段按64字节对齐
+ *
+ *   [Header][offset V+1][target E][weight E], 无权图没有weight段
+ *
+ * 加载时整个文件只读mmap, CSR直接指向映射, 无解析无拷贝
+ */
+
+struct GraphFileHeader {
+  static constexpr char MAGIC[8]{'G', 'R', 'A', 'P', 'H', 'C', 'S', 'R'};
+  static constexpr std::uint32_t VERSION{1}, ENDIAN{0x01020304};
+  char magic[8];
+  std::uint32_t version, endian;
+  std::uint32_t kind, directed, weighted, reserved;
+  std::int64_t V, E;
+  std::uint64_t offsetAt, targetAt, weightAt;
+};
+static_assert(sizeof(GraphFileHeader) == 72);
+
+// 四种图类型的编号, 加载时类型必须一致
+template <class G>
+  requires isGraphType<G>
+constexpr std::uint32_t graphKind() {
+  if constexpr (std::is_same_v<G, Graph>)
+    return 0;
+  else if constexpr (std::is_same_v<G, Digraph>)
+    return 1;
+  else if constexpr (std::is_same_v<G, EdgeWeightedGraph>)
+    return 2;
+  else
+    return 3;
+}
+
+template <class G>
+  requires isGraphType<G>
+GraphFileHeader makeHeader(int V, int E) {
+  GraphFileHeader h{};
+  std::memcpy(h.magic, GraphFileHeader::MAGIC, sizeof h.magic);
+  h.version = GraphFileHeader::VERSION, h.endian = GraphFileHeader::ENDIAN;
+  h.kind = graphKind<G>();
+  h.directed = CSR<G>::directed, h.weighted = CSR<G>::weighted;
+  h.V = V, h.E = E;
+  h.offsetAt = alignUp(sizeof h);
+  h.targetAt = alignUp(h.offsetAt + sizeof(int) * (V + 1));
+  h.weightAt = CSR<G>::weighted ? alignUp(h.targetAt + sizeof(int) * E) : 0;
+  return h;
+}
+
+// 写入失败返回false
+template <class G>
+bool writeGraph(const char *path, const CSR<G> &g) {
+  GraphFileHeader h{makeHeader<G>(g.V, g.E)};
+  AlignedWriter out(path);
+  out.put(0, &h, sizeof h)
+      .put(h.offsetAt, g.offset, sizeof(int) * (g.V + 1))
+      .put(h.targetAt, g.target, sizeof(int) * g.E);
+  if constexpr (CSR<G>::weighted)
+    out.put(h.weightAt, g.weight, sizeof(int) * g.E);
+  return out.close();
+}
+
+template <class G>
+  requires isGraphType<G>
+bool writeGraph(const char *path, const G &g) {
+  return writeGraph(path, CSR<G>(g));
+}
+
+// 文件不存在, 类型或版本不符, 长度不足, offset递减或target越界时返回空
+template <class G>
+  requires isGraphType<G>
+std::optional<CSR<G>> loadGraph(const char *path) {
+  auto file{MappedFile::open(path, sizeof(GraphFileHeader))};
+  if (!file)
+    return std::nullopt;
+
+  const auto &h{*file->at<GraphFileHeader>(0)};
+  auto at = [&](std::uint64_t off) { return file->at<int>(off); };
+  bool ok{0 <= h.V && h.V < INT32_MAX && 0 <= h.E && h.E < INT32_MAX};
+  if (ok) {
+    GraphFileHeader want{makeHeader<G>(h.V, h.E)};
+    std::uint64_t end{(CSR<G>::weighted ? h.weightAt : h.targetAt) +
+                      sizeof(int) * h.E};
+    ok = std::memcmp(&h, &want, sizeof h) == 0 && end <= file->length &&
+         at(h.offsetAt)[0] == 0 && at(h.offsetAt)[h.V] == h.E;
+  }
+  // 算法按offset和target直接下标访问, 损坏的文件须在这里拒绝
+  if (ok) {
+    const int *offset{at(h.offsetAt)}, *target{at(h.targetAt)};
+    ok = std::is_sorted(offset, offset + h.V + 1) &&
+         std::all_of(target, target + h.E,
+                     [&](int w) { return 0 <= w && w < h.V; });
+  }
+  if (!ok)
+    return std::nullopt;
+  file->willNeed();
+  return std::optional<CSR<G>>{
+      std::in_place, int(h.V), int(h.E), at(h.offsetAt), at(h.targetAt),
+      CSR<G>::weighted ? at(h.weightAt) : nullptr, std::move(*file)};
+}
@@ -0,0 +1,74 @@
+#include "GraphGen.hh"
+#include "SPDikstra.hh"
+
+// 无自环, 无重边, 无向图无两点环
+void checkSimple(const EdgeList &L) {
+  for (int i = 0; i < L.E(); ++i) {
+    const auto &e{L.edges[i]};
+    assert(0 <= e.from && e.from < L.V && 0 <= e.to && e.to < L.V);
+    assert(e.from != e.to);
+    assert(L.directed || e.from < e.to);
+    if (i > 0) {
+      const auto &f{L.edges[i - 1]};
+      assert(f.from != e.from || f.to != e.to);
+    }
+  }
+}
+
+void printDegree(const char *name, const EdgeList &L) {
+  CSR<Graph> G{toCSR<Graph>(L)};
+  int max{0};
+  for (int v = 0; v < G.V; ++v)
+    max = std::max(max, G.adj[v].size());
+  std::print("{}\tV {}\tE {}\tmaxDegree {}\n", name, G.V, L.E(), max);
+}
+
+int main() {
+  ThreadPool pool(4);
+  constexpr std::uint64_t seed{20240601};
+
+  EdgeList ER{generateErdosRenyi(4096, 32768, seed, false, 7, pool)};
+  checkSimple(ER);
+  assert(ER.E() == 32768);
+  printDegree("ErdosRenyi", ER);
+
+  EdgeList RMAT{generateRMAT(12, 16, seed, false, 7, 0.57, 0.19, 0.19, pool)};
+  checkSimple(RMAT);
+  printDegree("RMAT", RMAT);
+
+  EdgeList PL{generatePowerLaw(4096, 32768, 2.5, seed, false, 7, pool)};
+  checkSimple(PL);
+  printDegree("PowerLaw", PL);
+
+  EdgeList Grid{generateGrid(64, 64, seed)};
+  checkSimple(Grid);
+  assert(Grid.E() == 2 * 64 * 63);
+  printDegree("Grid", Grid);
+
+  // 同一种子的结果与线程数无关
+  ThreadPool single(1);
+  EdgeList again{generateRMAT(12, 16, seed, false, 7, 0.57, 0.19, 0.19,
+                              single)};
+  assert(again.E() == RMAT.E());
+  for (int i = 0; i < RMAT.E(); ++i)
+    assert(again.edges[i].from == RMAT.edges[i].from &&
+           again.edges[i].to == RMAT.edges[i].to &&
+           again.edges[i].weight == RMAT.edges[i].weight);
+
+  // 直接构造的CSR与经由邻接表的CSR上最短路一致
+  EdgeList D{generateErdosRenyi(1024, 8192, seed, true, 7, pool)};
+  checkSimple(D);
+  EdgeWeightedDigraph EWD{toGraph<EdgeWeightedDigraph>(D)};
+  CSR<EdgeWeightedDigraph> csr{toCSR<EdgeWeightedDigraph>(D)};
+  DikstraSP DSP(EWD, 0), CDSP(csr, 0);
+  assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(), CDSP.distTo.begin(),
+                    CDSP.distTo.end()));
+
+  // generateGraph按种子复现
+  Graph G1(64), G2(64);
+  generateGraph(G1, 512, seed);
+  generateGraph(G2, 512, seed);
+  for (int v = 0; v < 64; ++v)
+    assert(std::equal(G1.adj[v].begin(), G1.adj[v].end(), G2.adj[v].begin(),
+                      G2.adj[v].end()));
+}
@@ -0,0 +1,229 @@
+#pragma once
+#include "CSR.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string_view>
+
+// 边表, 无向图的边只存一个方向
+struct EdgeList {
+  int V;
+  bool directed;
+  ns::vector<DirectedEdge> edges;
+  int E() const { return edges.size(); }
+};
+
+// 可复现的分块随机数, 结果与线程数无关
+inline std::uint64_t splitmix64(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+// 每块2^16条边用独立的随机数发生器并行生成, gen(mt, edge)
+template <class F>
+void generateEdges(EdgeList &L, int m, std::uint64_t seed, ThreadPool &pool,
+                   F &&gen) {
+  constexpr long chunk{1 << 16};
+  int base{L.E()};
+  assert(long(base) + m <= INT_MAX);
+  ns::vector<DirectedEdge> edges(base + m);
+  std::copy(L.edges.begin(), L.edges.end(), edges.begin());
+  pool.parallelFor((m + chunk - 1) / chunk, 1, [&](long lo, long hi, int) {
+    for (long c = lo; c < hi; ++c) {
+      std::mt19937_64 mt(splitmix64(seed ^ splitmix64(base + c)));
+      for (long i = c * chunk, end = std::min<long>(m, i + chunk); i < end;
+           ++i)
+        gen(mt, edges[base + i]);
+    }
+  });
+  L.edges = std::move(edges);
+}
+
+// 排序去掉自环与重边, 无向图按(min,max)规范化
+inline void dedup(EdgeList &L) {
+  auto &A{L.edges};
+  if (!L.directed)
+    for (auto &e : A)
+      if (e.from > e.to)
+        std::swap(e.from, e.to);
+  auto key = [](const DirectedEdge &e) {
+    return std::uint64_t(e.from) << 32 | std::uint32_t(e.to);
+  };
+  std::sort(A.begin(), A.end(), [&](const DirectedEdge &a,
+                                    const DirectedEdge &b) {
+    return key(a) < key(b);
+  });
+  int n{0};
+  for (int i = 0; i < A.size(); ++i)
+    if (A[i].from != A[i].to && (n == 0 || key(A[n - 1]) != key(A[i])))
+      A[n++] = A[i];
+  while (A.size() > n)
+    A.pop_back();
+}
+
+// Erdős–Rényi G(n,m), 恰好m条不同的边
+inline EdgeList generateErdosRenyi(int V, int m, std::uint64_t seed,
+                                   bool directed = false, int maxWeight = 7,
+                                   ThreadPool &pool = ThreadPool::global()) {
+  assert(V > 1 && m <= (directed ? 1.0 : 0.5) * V * (V - 1));
+  EdgeList L{V, directed, {}};
+  for (int round = 0; L.E() < m; ++round) {
+    generateEdges(L, m - L.E(), splitmix64(seed + round), pool,
+                  [&](std::mt19937_64 &mt, DirectedEdge &e) {
+                    e = {int(mt() % V), int(mt() % V),
+                         int(mt() % (maxWeight + 1))};
+                  });
+    dedup(L);
+  }
+  return L;
+}
+
+// R-MAT/Kronecker, 2^scale个顶点, 每条边逐位按a,b,c,d选象限, 再随机重排顶点
+inline EdgeList generateRMAT(int scale, int edgeFactor, std::uint64_t seed,
+                             bool directed = false, int maxWeight = 7,
+                             double a = 0.57, double b = 0.19, double c = 0.19,
+                             ThreadPool &pool = ThreadPool::global()) {
+  // 边数用long算, 须放得进EdgeList的int下标
+  long m{(1L << scale) * edgeFactor};
+  assert(0 <= scale && scale < 31 && 0 <= m && m <= INT_MAX);
+  int V{1 << scale};
+  EdgeList L{V, directed, {}};
+  // 概率量化到16位, 一个64位随机数决定4位
+  std::uint64_t ta(a * 65536), tab((a + b) * 65536), tabc((a + b + c) * 65536);
+  generateEdges(L, int(m), seed, pool,
+                [&](std::mt19937_64 &mt, DirectedEdge &e) {
+                  int u{0}, v{0};
+                  std::uint64_t bits{0};
+                  for (int bit = 0; bit < scale; ++bit, bits >>= 16) {
+                    if (bit % 4 == 0)
+                      bits = mt();
+                    std::uint64_t x{bits & 0xffff};
+                    u = u << 1 | (x >= tab);
+                    v = v << 1 | (x >= ta && (x < tab || x >= tabc));
+                  }
+                  e = {u, v, int(mt() % (maxWeight + 1))};
+                });
+  ns::vector<int> perm(V);
+  for (int v = 0; v < V; ++v)
+    perm[v] = v;
+  std::shuffle(perm.begin(), perm.end(), std::mt19937_64(splitmix64(~seed)));
+  for (auto &e : L.edges)
+    e.from = perm[e.from], e.to = perm[e.to];
+  dedup(L);
+  return L;
+}
+
+// 二维网格, 类似路网: 度数低, 直径大
+inline EdgeList generateGrid(int rows, int cols, std::uint64_t seed,
+                             bool directed = false, int maxWeight = 7) {
+  EdgeList L{rows * cols, directed, {}};
+  std::mt19937_64 mt(seed);
+  auto add = [&](int v, int w) {
+    int wt(mt() % (maxWeight + 1));
+    L.edges.push_back(v, w, wt);
+    if (directed)
+      L.edges.push_back(w, v, wt);
+  };
+  for (int r = 0; r < rows; ++r)
+    for (int c = 0; c < cols; ++c) {
+      if (c + 1 < cols)
+        add(r * cols + c, r * cols + c + 1);
+      if (r + 1 < rows)
+        add(r * cols + c, (r + 1) * cols + c);
+    }
+  return L;
+}
+
+// Chung–Lu幂律图, 顶点i的期望度数正比于(i+1)^(-1/(gamma-1))
+inline EdgeList generatePowerLaw(int V, int m, double gamma,
+                                 std::uint64_t seed, bool directed = false,
+                                 int maxWeight = 7,
+                                 ThreadPool &pool = ThreadPool::global()) {
+  assert(gamma > 2);
+  ns::vector<double> cdf(V);
+  double sum{0};
+  for (int i = 0; i < V; ++i)
+    cdf[i] = sum += std::pow(i + 1, -1 / (gamma - 1));
+  EdgeList L{V, directed, {}};
+  generateEdges(L, m, seed, pool, [&](std::mt19937_64 &mt, DirectedEdge &e) {
+    std::uniform_real_distribution<double> r(0, sum);
+    auto pick = [&] {
+      int v(std::upper_bound(cdf.begin(), cdf.end(), r(mt)) - cdf.begin());
+      return std::min(v, V - 1);
+    };
+    int u{pick()}, v{pick()};
+    e = {u, v, int(mt() % (maxWeight + 1))};
+  });
+  dedup(L);
+  return L;
+}
+
+// 按名字生成约n个顶点, 平均度数8的图, 名字无效时返回空
+inline std::optional<EdgeList> generateByName(std::string_view name, int n,
+                                              std::uint64_t seed,
+                                              bool directed) {
+  if (name == "ErdosRenyi")
+    return generateErdosRenyi(n, 8 * n, seed, directed);
+  if (name == "RMAT")
+    return generateRMAT(std::bit_width(unsigned(n)) - 1, 8, seed, directed);
+  if (name == "PowerLaw")
+    return generatePowerLaw(n, 8 * n, 2.5, seed, directed);
+  if (name == "Grid") {
+    int side(std::sqrt(n));
+    return generateGrid(side, side, seed, directed);
+  }
+  return std::nullopt;
+}
+
+template <class G>
+  requires isGraphType<G>
+G toGraph(const EdgeList &L) {
+  assert(L.directed == CSR<G>::directed);
+  G g(L.V);
+  for (const auto &e : L.edges) {
+    if constexpr (std::is_same_v<G, Graph> || std::is_same_v<G, Digraph>)
+      g.addEdge(e.from, e.to);
+    else if constexpr (std::is_same_v<G, EdgeWeightedGraph>)
+      g.addEdge({e.from, e.to, e.weight});
+    else
+      g.addEdge(e);
+  }
+  return g;
+}
+
+// 不经过邻接表直接计数排序成CSR
+template <class G>
+  requires isGraphType<G>
+CSR<G> toCSR(const EdgeList &L) {
+  assert(L.directed == CSR<G>::directed);
+  CSR<G> g(L.V, L.directed ? L.E() : 2 * L.E());
+  for (const auto &e : L.edges) {
+    ++g.own.offset[e.from + 1];
+    if (!L.directed)
+      ++g.own.offset[e.to + 1];
+  }
+  for (int v = 0; v < L.V; ++v)
+    g.own.offset[v + 1] += g.offset[v];
+  ns::vector<int> next(L.V);
+  std::copy(g.offset, g.offset + L.V, next.begin());
+  auto add = [&](int v, int w, int weight) {
+    int i{next[v]++};
+    g.own.target[i] = w;
+    if constexpr (CSR<G>::weighted)
+      g.own.weight[i] = weight;
+  };
+  for (const auto &e : L.edges) {
+    add(e.from, e.to, e.weight);
+    if (!L.directed)
+      add(e.to, e.from, e.weight);
+  }
+  return g;
+}
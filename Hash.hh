@@ -0,0 +1,18 @@
+#pragma once
+#include <concepts>
+#include <cstdint>
+#include <functional>
+
+template <typename T>
+concept is_hashable = requires(T a) {
+  { std::hash<T>{}(a) } -> std::convertible_to<std::size_t>;
+};
+
+// std::hash<int>是恒等映射, 用MurmurHash3的fmix64把各位混匀
+inline std::uint64_t mixHash(std::uint64_t h) {
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccd;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53;
+  return h ^ h >> 33;
+}
@@ -1,6 +1,26 @@
+#include "Hash.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
 #include <concepts>
+#include <cstdint>
 #include <functional>
+#include <mutex>
+#include <new>
+#include <optional>
 #include <print>
+#include <random>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#ifdef __SSE2__
+#include <immintrin.h>
+#endif
 
 template <class Key, class Value>
   requires std::equality_comparable<Key>
@@ -39,6 +59,10 @@ struct SequentialSearchST {
         x->val = val;
         return;
       }
+    push(key, val);
+  }
+  // 已知key不在表中, 直接放到表头
+  void push(Key key, Value val) {
     first = new Node(key, val, first);
     ++sz;
   }
@@ -58,14 +82,18 @@ struct SequentialSearchST {
   }
 };
 
-template <typename T>
-concept is_hashable = requires(T a) {
-  { std::hash<T>{}(a) } -> std::convertible_to<std::size_t>;
-};
+// 批量操作每组的键数, 一组先全部算散列并预取, 再逐个完成, 访存延迟互相重叠
+constexpr int BATCH{16};
 
+/**
+ * 批量接口: searchMany, insertMany分三趟处理一组键
+ *   算出桶号并预取桶头, 读出链首并预取首结点, 最后逐个走链
+ * 批量建表时桶数取键数, 先按桶计数排序再逐桶插入, 同一条链的结点连续分配
+ */
 template <class Key, class Value>
   requires is_hashable<Key>
 struct SeparateChainingHashST {
+  using Node = SequentialSearchST<Key, Value>::Node;
   int N, M;
   std::hash<Key> hashCode;
   SequentialSearchST<Key, Value> *st;
@@ -76,6 +104,30 @@ struct SeparateChainingHashST {
   SeparateChainingHashST(int M)
       : N{0}, M{M}, hashCode{}, st{new SequentialSearchST<Key, Value>[M]} {}
 
+  // 重复的键后出现的覆盖前面的; sorted表示keys已升序, 重复键相邻, 省去链上查重
+  SeparateChainingHashST(std::span<const Key> keys,
+                         std::span<const Value> vals, bool sorted = false)
+      : SeparateChainingHashST(std::max(1, int(keys.size()))) {
+    assert(keys.size() == vals.size());
+    int n(keys.size());
+    ns::vector<int> bucket(n), start(M + 1, 0), order(n);
+    for (int i = 0; i < n; ++i)
+      ++start[(bucket[i] = hash(keys[i])) + 1];
+    for (int b = 0; b < M; ++b)
+      start[b + 1] += start[b];
+    for (int i = 0; i < n; ++i)
+      order[start[bucket[i]]++] = i;
+    for (int i : order) {
+      auto &chain{st[bucket[i]]};
+      int before{chain.sz};
+      if (!sorted)
+        chain.insert(keys[i], vals[i]);
+      else if (i + 1 == n || !(keys[i + 1] == keys[i]))
+        chain.push(keys[i], vals[i]);
+      N += chain.sz - before;
+    }
+  }
+
   ~SeparateChainingHashST() { delete[] st; }
 
   int hash(Key key) const { return (hashCode(key) & 0x7fffffffffffffff) % M; }
@@ -94,11 +146,723 @@ struct SeparateChainingHashST {
     st[hash(key)].remove(key);
   }
 
+  // 一组内前两趟只发预取, 第三趟对f(i, 桶)逐个求值
+  template <class F> void batch(std::span<const Key> keys, F f) const {
+    int n(keys.size()), b[BATCH];
+    for (int lo = 0; lo < n; lo += BATCH) {
+      int m{std::min(BATCH, n - lo)};
+      for (int j = 0; j < m; ++j) {
+        b[j] = hash(keys[lo + j]);
+        __builtin_prefetch(&st[b[j]]);
+      }
+      for (int j = 0; j < m; ++j)
+        __builtin_prefetch(st[b[j]].first);
+      for (int j = 0; j < m; ++j)
+        f(lo + j, st[b[j]]);
+    }
+  }
+
+  // out[i]为keys[i]所在的结点, 不存在时为nullptr
+  void searchMany(std::span<const Key> keys, std::span<Node *> out) const {
+    assert(keys.size() == out.size());
+    batch(keys, [&](int i, auto &chain) { out[i] = chain.search(keys[i]); });
+  }
+
+  void insertMany(std::span<const Key> keys, std::span<const Value> vals) {
+    assert(keys.size() == vals.size());
+    batch(keys, [&](int i, auto &chain) {
+      int before{chain.sz};
+      chain.insert(keys[i], vals[i]);
+      N += chain.sz - before;
+    });
+  }
+
   auto loadFactor() { return N / M; }
   int size() const { return N; }
   bool empty() const { return size() == 0; }
 };
 
+// 控制字节: 空为0x80, 占用时为散列值的低7位; 一组16个一次比较
+constexpr signed char CTRL_EMPTY{-128};
+constexpr int GROUP{16};
+
+struct CtrlGroup {
+#ifdef __SSE2__
+  __m128i g;
+  explicit CtrlGroup(const signed char *p)
+      : g{_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))} {}
+  unsigned match(signed char h2) const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8(h2)));
+  }
+  // 只有空字节的最高位是1
+  unsigned empty() const { return _mm_movemask_epi8(g); }
+#else
+  const signed char *p;
+  explicit CtrlGroup(const signed char *p) : p{p} {}
+  unsigned match(signed char h2) const {
+    unsigned m{0};
+    for (int i = 0; i < GROUP; ++i)
+      m |= unsigned(p[i] == h2) << i;
+    return m;
+  }
+  unsigned empty() const { return match(CTRL_EMPTY); }
+#endif
+};
+
+/**
+ * 开放寻址散列表, Swiss table的控制字节 + 线性探查
+ *   散列值高位定起点, 低7位存进控制字节; 从起点连续取16个控制字节,
+ *   SIMD一次比出所有低7位相同的位置, 再逐个比键
+ *   线性探查下键总在起点之后的连续段里, 组里出现空字节即可断定不存在,
+ *   插入也就落在第一个空位上, 一趟探查完成查找与插入
+ *   删除后把后面不在自己起点上的元素前移填空(backward shift), 没有墓碑
+ *   容量为2的幂, 装载超过7/8时翻倍; 元素在槽里就地构造
+ * ctrl末尾多存GROUP - 1个开头字节的副本, 起点靠近末尾时也能整组读
+ */
+template <class Key, class Value>
+  requires is_hashable<Key>
+struct SwissHashST {
+  struct Slot {
+    Key key;
+    Value val;
+  };
+  int N{0}, M{0};
+  std::hash<Key> hashCode;
+  signed char *ctrl{nullptr};
+  Slot *slots{nullptr};
+
+  SwissHashST(int capacity = GROUP) { allocate(capacity); }
+  // 批量建表, 容量按keys全不相同一次取够, 重复的键后出现的覆盖前面的;
+  // 重复很多时表会偏大, 此时宜从空表insertMany, 按实际新键扩容
+  SwissHashST(std::span<const Key> keys, std::span<const Value> vals)
+      : SwissHashST(fit(keys.size())) {
+    insertMany(keys, vals);
+  }
+  SwissHashST(const SwissHashST &) = delete;
+  SwissHashST &operator=(const SwissHashST &) = delete;
+  ~SwissHashST() { release(); }
+
+  void allocate(int capacity) {
+    M = std::max(GROUP, int(std::bit_ceil(unsigned(capacity))));
+    ctrl = new signed char[M + GROUP - 1];
+    std::fill(ctrl, ctrl + M + GROUP - 1, CTRL_EMPTY);
+    slots = static_cast<Slot *>(::operator new(sizeof(Slot) * M));
+  }
+  void release() {
+    for (int i = 0; i < M; ++i)
+      if (ctrl[i] != CTRL_EMPTY)
+        slots[i].~Slot();
+    ::operator delete(slots);
+    delete[] ctrl;
+  }
+
+  std::uint64_t hash(const Key &key) const { return mixHash(hashCode(key)); }
+  int home(std::uint64_t h) const { return (h >> 7) & (M - 1); }
+  static signed char tag(std::uint64_t h) { return h & 0x7f; }
+  void setCtrl(int i, signed char c) {
+    ctrl[i] = c;
+    if (i < GROUP - 1)
+      ctrl[M + i] = c;
+  }
+
+  // 找到key返回其下标; 否则返回~空位下标, 新键应放在那里
+  int probe(const Key &key, std::uint64_t h) const {
+    signed char h2{tag(h)};
+    for (int pos = home(h);; pos = (pos + GROUP) & (M - 1)) {
+      CtrlGroup g{ctrl + pos};
+      for (unsigned m = g.match(h2); m; m &= m - 1) {
+        int i{(pos + std::countr_zero(m)) & (M - 1)};
+        if (slots[i].key == key)
+          return i;
+      }
+      if (unsigned e{g.empty()})
+        return ~((pos + std::countr_zero(e)) & (M - 1));
+    }
+  }
+
+  Value *search(const Key &key) {
+    int i{probe(key, hash(key))};
+    return i >= 0 ? &slots[i].val : nullptr;
+  }
+  const Value *search(const Key &key) const {
+    return const_cast<SwissHashST *>(this)->search(key);
+  }
+  bool contains(const Key &key) const { return search(key); }
+
+  // 一组先算散列, 预取起点的控制字节和槽, 再逐个探查
+  void searchMany(std::span<const Key> keys, std::span<Value *> out) {
+    assert(keys.size() == out.size());
+    int n(keys.size());
+    std::uint64_t h[BATCH];
+    for (int lo = 0; lo < n; lo += BATCH) {
+      int m{std::min(BATCH, n - lo)};
+      for (int j = 0; j < m; ++j) {
+        h[j] = hash(keys[lo + j]);
+        __builtin_prefetch(ctrl + home(h[j]));
+        __builtin_prefetch(slots + home(h[j]));
+      }
+      for (int j = 0; j < m; ++j) {
+        int i{probe(keys[lo + j], h[j])};
+        out[lo + j] = i >= 0 ? &slots[i].val : nullptr;
+      }
+    }
+  }
+
+  // 新键插入前才检查装载, 已有的键和组内重复的键不占容量;
+  // 扩容后表已搬动, 本组剩下的键重新预取
+  void insertMany(std::span<const Key> keys, std::span<const Value> vals) {
+    assert(keys.size() == vals.size());
+    int n(keys.size());
+    std::uint64_t h[BATCH];
+    auto prefetch = [&](int j) {
+      __builtin_prefetch(ctrl + home(h[j]));
+      __builtin_prefetch(slots + home(h[j]));
+    };
+    for (int lo = 0; lo < n; lo += BATCH) {
+      int m{std::min(BATCH, n - lo)};
+      for (int j = 0; j < m; ++j) {
+        h[j] = hash(keys[lo + j]);
+        prefetch(j);
+      }
+      for (int j = 0; j < m; ++j) {
+        const Key &key{keys[lo + j]};
+        int i{probe(key, h[j])};
+        if (i >= 0) {
+          slots[i].val = vals[lo + j];
+          continue;
+        }
+        if (8L * (N + 1) > 7L * M) {
+          grow();
+          for (int k = j; k < m; ++k)
+            prefetch(k);
+          i = probe(key, h[j]);
+        }
+        new (&slots[~i]) Slot{key, vals[lo + j]};
+        setCtrl(~i, tag(h[j]));
+        ++N;
+      }
+    }
+  }
+
+  // 一次散列一趟探查: 找到key返回{下标, false}, 参数原样不动;
+  // 否则在空位就地构造, 返回{下标, true}; 只有扩容后才重新探查
+  template <class... Args>
+  std::pair<int, bool> tryEmplace(const Key &key, Args &&...args) {
+    std::uint64_t h{hash(key)};
+    int i{probe(key, h)};
+    if (i >= 0)
+      return {i, false};
+    if (8L * (N + 1) > 7L * M) {
+      grow();
+      i = probe(key, h);
+    }
+    i = ~i;
+    new (&slots[i]) Slot{key, Value(std::forward<Args>(args)...)};
+    setCtrl(i, tag(h));
+    ++N;
+    return {i, true};
+  }
+  // 已有key时不改动, 返回值为真表示新插入
+  template <class... Args> bool emplace(const Key &key, Args &&...args) {
+    return tryEmplace(key, std::forward<Args>(args)...).second;
+  }
+  void insert(const Key &key, Value val) {
+    if (auto [i, fresh]{tryEmplace(key, std::move(val))}; !fresh)
+      slots[i].val = std::move(val);
+  }
+
+  // 装下n个元素且装载不超过7/8的容量
+  static int fit(long n) { return std::max<long>(GROUP, (8 * n + 6) / 7); }
+  void reserve(int n) {
+    if (8L * n > 7L * M)
+      grow(fit(n));
+  }
+
+  void grow() { grow(2 * M); }
+  void grow(int capacity) {
+    signed char *oldCtrl{ctrl};
+    Slot *oldSlots{slots};
+    int oldM{M};
+    allocate(capacity);
+    for (int i = 0; i < oldM; ++i)
+      if (oldCtrl[i] != CTRL_EMPTY) {
+        std::uint64_t h{hash(oldSlots[i].key)};
+        int j{~probe(oldSlots[i].key, h)};
+        new (&slots[j]) Slot{std::move(oldSlots[i])};
+        setCtrl(j, tag(h));
+        oldSlots[i].~Slot();
+      }
+    ::operator delete(oldSlots);
+    delete[] oldCtrl;
+  }
+
+  void remove(const Key &key) {
+    int i{probe(key, hash(key))};
+    if (i < 0)
+      return;
+    slots[i].~Slot();
+    --N;
+    // j的起点不在(i, j]之间时, j可以前移到空位i
+    int mask{M - 1};
+    for (int j = (i + 1) & mask; ctrl[j] != CTRL_EMPTY; j = (j + 1) & mask)
+      if (((j - home(hash(slots[j].key))) & mask) >= ((j - i) & mask)) {
+        new (&slots[i]) Slot{std::move(slots[j])};
+        slots[j].~Slot();
+        setCtrl(i, ctrl[j]);
+        i = j;
+      }
+    setCtrl(i, CTRL_EMPTY);
+  }
+
+  double loadFactor() const { return double(N) / M; }
+  int size() const { return N; }
+  bool empty() const { return size() == 0; }
+};
+
+/**
+ * Robin Hood线性探查, 键, 值, 探查距离分存三个连续数组
+ *   dist为离起点的距离加1, 0表示空; 插入途中遇到离起点比自己近的元素,
+ *   就占下它的槽, 带着被挤出的元素继续往后找
+ *   于是一段里的元素按起点排列, 查找走到dist小于已走步数即可断定不存在,
+ *   探查长度的方差很小, 高装载下尾延迟也平稳
+ *   删除后把后面dist大于1的元素依次前移一格(backward shift), 没有墓碑
+ *   装载超过maxLoad或距离超出一个字节时翻倍
+ */
+template <class Key, class Value>
+  requires is_hashable<Key>
+struct RobinHoodHashST {
+  int N{0}, M;
+  double maxLoad;
+  std::hash<Key> hashCode;
+  ns::vector<Key> keys;
+  ns::vector<Value> vals;
+  ns::vector<unsigned char> dist;
+
+  RobinHoodHashST(int capacity = 16, double maxLoad = 0.9)
+      : M{int(std::bit_ceil(unsigned(std::max(capacity, 2))))},
+        maxLoad{std::clamp(maxLoad, 0.1, 0.99)}, keys(M), vals(M),
+        dist(M, 0) {}
+
+  int home(const Key &key) const { return mixHash(hashCode(key)) & (M - 1); }
+
+  // 键数组与dist数组同时取, 两次缓存缺失重叠
+  int find(const Key &key) const {
+    int h{home(key)};
+    __builtin_prefetch(&keys[h]);
+    for (int i = h, d = 1; dist[i] >= d; i = (i + 1) & (M - 1), ++d)
+      if (dist[i] == d && keys[i] == key)
+        return i;
+    return -1;
+  }
+  Value *search(const Key &key) {
+    int i{find(key)};
+    return i < 0 ? nullptr : &vals[i];
+  }
+  bool contains(const Key &key) const { return find(key) >= 0; }
+
+  // 一趟探查: 找到就更新, 否则停下的位置就是key该放的地方
+  void insert(Key key, Value val) {
+    int i{home(key)}, d{1};
+    for (; dist[i] >= d; i = (i + 1) & (M - 1), ++d)
+      if (dist[i] == d && keys[i] == key) {
+        vals[i] = std::move(val);
+        return;
+      }
+    ++N;
+    if (N > maxLoad * M) {
+      grow();
+      i = home(key), d = 1;
+    }
+    place(std::move(key), std::move(val), i, d);
+  }
+
+  // 从第i个槽起放入距离为d的元素, 需要时挤出别的元素
+  void place(Key key, Value val, int i, int d) {
+    for (;; i = (i + 1) & (M - 1), ++d) {
+      // 实参求值顺序未定, 起点须在key被移走之前算好
+      if (d > 255) {
+        grow();
+        int h{home(key)};
+        return place(std::move(key), std::move(val), h, 1);
+      }
+      if (dist[i] == 0) {
+        keys[i] = std::move(key), vals[i] = std::move(val), dist[i] = d;
+        return;
+      }
+      if (dist[i] < d) {
+        std::swap(key, keys[i]);
+        std::swap(val, vals[i]);
+        d = std::exchange(dist[i], d);
+      }
+    }
+  }
+
+  void grow() {
+    ns::vector<Key> oldKeys{std::move(keys)};
+    ns::vector<Value> oldVals{std::move(vals)};
+    ns::vector<unsigned char> oldDist{std::move(dist)};
+    M *= 2;
+    keys = ns::vector<Key>(M), vals = ns::vector<Value>(M);
+    dist = ns::vector<unsigned char>(M, 0);
+    for (int i = 0; i < oldDist.size(); ++i)
+      if (oldDist[i]) {
+        int h{home(oldKeys[i])};
+        place(std::move(oldKeys[i]), std::move(oldVals[i]), h, 1);
+      }
+  }
+
+  void remove(const Key &key) {
+    int i{find(key)};
+    if (i < 0)
+      return;
+    --N;
+    for (int j = (i + 1) & (M - 1); dist[j] > 1; i = j, j = (j + 1) & (M - 1)) {
+      keys[i] = std::move(keys[j]), vals[i] = std::move(vals[j]);
+      dist[i] = dist[j] - 1;
+    }
+    keys[i] = Key{}, vals[i] = Value{}, dist[i] = 0;
+  }
+
+  double loadFactor() const { return double(N) / M; }
+  int size() const { return N; }
+  bool empty() const { return size() == 0; }
+};
+
+/**
+ * 并发散列表, 按散列值最高6位分成64个分片, 每片是一张线性探查表
+ *   读不加锁: 槽的状态, 键, 值都是原子量, 写者先写键值再release状态,
+ *   读者acquire看到满就能读到完整的键值; 删除只把状态改成已删除,
+ *   槽在本表里不再复用, 读者不会拿到别的键的值
+ *   写按分片加锁, 已删除的槽一并计入装载, 超过3/4时重建本分片:
+ *   活的元素多就翻倍, 否则同样大小只清掉已删除的槽
+ *   重建只锁住一个分片, 新表建好后原子地换上, 旧表上的读者照常读完
+ *   读者进出时在线程对应的计数上加减1, 换表后每个计数都见过0才释放旧表
+ * 键和值须能无锁原子读写
+ */
+template <class Key, class Value>
+  requires is_hashable<Key> && std::atomic<Key>::is_always_lock_free &&
+           std::atomic<Value>::is_always_lock_free
+struct ConcurrentHashST {
+  static constexpr int SHARDS{64}, STRIPES{64};
+  enum : unsigned char { EMPTY, FULL, DELETED };
+  struct Slot {
+    std::atomic<unsigned char> state{EMPTY};
+    std::atomic<Key> key;
+    std::atomic<Value> val;
+  };
+  struct Table {
+    int M;
+    Slot *slots;
+    Table(int M) : M{M}, slots{new Slot[M]} {}
+    ~Table() { delete[] slots; }
+  };
+  struct alignas(64) Shard {
+    std::mutex mtx;
+    std::atomic<Table *> table{new Table(GROUP)};
+    int used{0};
+    std::atomic<int> live{0};
+  };
+  struct alignas(64) Stripe {
+    std::atomic<int> active{0};
+  };
+  std::hash<Key> hashCode;
+  Shard shards[SHARDS];
+  Stripe stripes[STRIPES];
+
+  ConcurrentHashST() {}
+  ConcurrentHashST(const ConcurrentHashST &) = delete;
+  ConcurrentHashST &operator=(const ConcurrentHashST &) = delete;
+  ~ConcurrentHashST() {
+    for (Shard &s : shards)
+      delete s.table.load();
+  }
+
+  std::uint64_t hash(const Key &key) const { return mixHash(hashCode(key)); }
+  Shard &shard(std::uint64_t h) { return shards[h >> 58]; }
+
+  // 每个线程固定用一个计数
+  static int stripe() {
+    static std::atomic<int> next{0};
+    thread_local int id{next.fetch_add(1) % STRIPES};
+    return id;
+  }
+
+  std::optional<Value> search(const Key &key) {
+    std::uint64_t h{hash(key)};
+    Stripe &r{stripes[stripe()]};
+    r.active.fetch_add(1);
+    const Table *t{shard(h).table.load()};
+    std::optional<Value> v;
+    for (int i = h & (t->M - 1);; i = (i + 1) & (t->M - 1)) {
+      const Slot &x{t->slots[i]};
+      unsigned char st{x.state.load(std::memory_order_acquire)};
+      if (st == EMPTY)
+        break;
+      if (st == FULL && x.key.load(std::memory_order_relaxed) == key) {
+        v = x.val.load(std::memory_order_acquire);
+        break;
+      }
+    }
+    r.active.fetch_sub(1, std::memory_order_release);
+    return v;
+  }
+  bool contains(const Key &key) { return search(key).has_value(); }
+
+  // 以下在分片锁内, 槽只会被本分片的写者改动
+  // key所在的槽, 没有时为探查路径上的第一个空槽
+  static int probe(const Table *t, const Key &key, std::uint64_t h) {
+    for (int i = h & (t->M - 1);; i = (i + 1) & (t->M - 1)) {
+      const Slot &x{t->slots[i]};
+      unsigned char st{x.state.load(std::memory_order_relaxed)};
+      if (st == EMPTY ||
+          (st == FULL && x.key.load(std::memory_order_relaxed) == key))
+        return i;
+    }
+  }
+  static void fill(Slot &x, const Key &key, const Value &val) {
+    x.key.store(key, std::memory_order_relaxed);
+    x.val.store(val, std::memory_order_relaxed);
+    x.state.store(FULL, std::memory_order_release);
+  }
+
+  void insert(const Key &key, const Value &val) {
+    std::uint64_t h{hash(key)};
+    Shard &s{shard(h)};
+    std::lock_guard lock(s.mtx);
+    Table *t{s.table.load(std::memory_order_relaxed)};
+    int i{probe(t, key, h)};
+    if (t->slots[i].state.load(std::memory_order_relaxed) == FULL)
+      return t->slots[i].val.store(val, std::memory_order_release);
+    if (4 * (s.used + 1) > 3 * t->M) {
+      t = rebuild(s, t);
+      i = probe(t, key, h);
+    }
+    fill(t->slots[i], key, val);
+    ++s.used;
+    s.live.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  void remove(const Key &key) {
+    std::uint64_t h{hash(key)};
+    Shard &s{shard(h)};
+    std::lock_guard lock(s.mtx);
+    Table *t{s.table.load(std::memory_order_relaxed)};
+    Slot &x{t->slots[probe(t, key, h)]};
+    if (x.state.load(std::memory_order_relaxed) == FULL) {
+      x.state.store(DELETED, std::memory_order_release);
+      s.live.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+
+  Table *rebuild(Shard &s, Table *old) {
+    int live{s.live.load(std::memory_order_relaxed)};
+    Table *t{new Table(2 * (live + 1) > old->M / 2 ? 2 * old->M : old->M)};
+    for (int i = 0; i < old->M; ++i) {
+      const Slot &x{old->slots[i]};
+      if (x.state.load(std::memory_order_relaxed) != FULL)
+        continue;
+      Key key{x.key.load(std::memory_order_relaxed)};
+      fill(t->slots[probe(t, key, hash(key))], key,
+           x.val.load(std::memory_order_relaxed));
+    }
+    s.used = live;
+    // 换表之后才进入的读者都看到新表; 某时刻计数为0, 之前的读者就都已离开
+    s.table.store(t);
+    for (Stripe &r : stripes)
+      while (r.active.load() != 0)
+        std::this_thread::yield();
+    delete old;
+    return t;
+  }
+
+  int size() const {
+    int n{0};
+    for (const Shard &s : shards)
+      n += s.live.load(std::memory_order_relaxed);
+    return n;
+  }
+  bool empty() const { return size() == 0; }
+};
+
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  // 桶数固定, 链长随n线性增长
+  bench.map(
+      "SeparateChainingHashST",
+      [] { return std::make_unique<SeparateChainingHashST<int, int>>(); },
+      1 << 16);
+  bench.map("SwissHashST",
+            [] { return std::make_unique<SwissHashST<int, int>>(); });
+  bench.map("RobinHoodHashST",
+            [] { return std::make_unique<RobinHoodHashST<int, int>>(); });
+
+  // 装载固定在load时逐次计时的查找延迟, 一半命中; n取2的幂时表恰好不扩容
+  auto loaded = [&]<class Map>(std::string_view name, double load) {
+    struct State {
+      std::unique_ptr<Map> st;
+      ns::vector<int> queries;
+    };
+    bench.latency(
+        "map.search.loaded", name,
+        [&](int n, Dist) {
+          int M{int(std::bit_ceil(unsigned(n)))};
+          State s{std::make_unique<Map>(), ns::vector<int>(n)};
+          std::mt19937_64 mt(bench.seed);
+          ns::vector<int> keys(int(load * M));
+          for (int &k : keys) {
+            k = int(mt() >> 33);
+            s.st->insert(k, k);
+          }
+          for (int &q : s.queries)
+            q = mt() % 2 ? keys[mt() % keys.size()] : int(mt() >> 33);
+          return s;
+        },
+        [](State &s, int i) { keep(s.st->search(s.queries[i])); });
+  };
+  loaded.operator()<RobinHoodHashST<int, int>>("RobinHoodHashST<0.9>", 0.9);
+  loaded.operator()<SwissHashST<int, int>>("SwissHashST<0.85>", 0.85);
+
+  // 一次查完n个键, 一半命中: 逐个查找对照批量查找; 链表桶数取n
+  auto probes = [&]<class Map, class Out>(std::string_view name, bool many) {
+    struct State {
+      std::unique_ptr<Map> st;
+      ns::vector<int> queries;
+      ns::vector<Out> out;
+      int hits;
+    };
+    bench.bulk(
+        "map.search.batch", name,
+        [&](int n, Dist d) {
+          auto keys{benchData(d, n, bench.seed)};
+          State s{std::make_unique<Map>(keys, keys), ns::vector<int>(n),
+                  ns::vector<Out>(n), 0};
+          std::mt19937_64 mt(bench.seed);
+          for (int &q : s.queries)
+            q = mt() % 2 ? keys[mt() % n] : int(mt() >> 33);
+          for (int q : s.queries)
+            s.hits += bool(s.st->search(q));
+          return s;
+        },
+        [&](State &s) {
+          if (many)
+            s.st->searchMany(s.queries, s.out);
+          else
+            for (int i = 0; i < s.queries.size(); ++i)
+              s.out[i] = s.st->search(s.queries[i]);
+        },
+        [](State &s) {
+          return std::count(s.out.begin(), s.out.end(), nullptr) ==
+                 s.out.size() - s.hits;
+        });
+  };
+  using Chain = SeparateChainingHashST<int, int>;
+  probes.operator()<Chain, Chain::Node *>("SeparateChainingHashST", false);
+  probes.operator()<Chain, Chain::Node *>("SeparateChainingHashST<many>", true);
+  using Swiss = SwissHashST<int, int>;
+  probes.operator()<Swiss, int *>("SwissHashST", false);
+  probes.operator()<Swiss, int *>("SwissHashST<many>", true);
+
+  // 建表: 逐个插入, 批量插入, 批量建表; 前两者桶数同样取n
+  auto build = [&](std::string_view name, auto f) {
+    bench.bulk(
+        "map.build", name,
+        [&](int n, Dist d) { return benchData(d, n, bench.seed); },
+        [&](ns::vector<int> &keys) { keep(f(keys)->size()); },
+        [](ns::vector<int> &) { return true; });
+  };
+  build("SeparateChainingHashST", [](ns::vector<int> &keys) {
+    auto st{std::make_unique<Chain>(std::max(1, keys.size()))};
+    for (int k : keys)
+      st->insert(k, k);
+    return st;
+  });
+  build("SeparateChainingHashST<many>", [](ns::vector<int> &keys) {
+    auto st{std::make_unique<Chain>(std::max(1, keys.size()))};
+    st->insertMany(keys, keys);
+    return st;
+  });
+  build("SeparateChainingHashST<bulk>", [](ns::vector<int> &keys) {
+    return std::make_unique<Chain>(keys, keys);
+  });
+  build("SwissHashST", [](ns::vector<int> &keys) {
+    auto st{std::make_unique<Swiss>()};
+    for (int k : keys)
+      st->insert(k, k);
+    return st;
+  });
+  build("SwissHashST<many>", [](ns::vector<int> &keys) {
+    auto st{std::make_unique<Swiss>()};
+    st->insertMany(keys, keys);
+    return st;
+  });
+  build("SwissHashST<bulk>", [](ns::vector<int> &keys) {
+    return std::make_unique<Swiss>(keys, keys);
+  });
+
+  // 多线程混合读写, 预先装入n个键; 写一半插入一半删除, 键取自同一值域
+  struct Locked {
+    std::shared_mutex mtx;
+    std::unordered_map<int, int> map;
+    bool search(int k) {
+      std::shared_lock lock(mtx);
+      return map.contains(k);
+    }
+    void insert(int k, int v) {
+      std::lock_guard lock(mtx);
+      map[k] = v;
+    }
+    void remove(int k) {
+      std::lock_guard lock(mtx);
+      map.erase(k);
+    }
+    int size() { return map.size(); }
+  };
+  ThreadPool &pool{ThreadPool::global()}, serial(1);
+  auto mixed = [&]<class Map>(std::string_view name, int writes,
+                              ThreadPool &threads) {
+    bench.bulk(
+        "map.concurrent", name,
+        [&](int n, Dist d) {
+          auto s{std::make_unique<Map>()};
+          for (int k : benchData(d, n, bench.seed))
+            s->insert(k, k);
+          return s;
+        },
+        [&](std::unique_ptr<Map> &s) {
+          int n{s->size()}, t{threads.size()};
+          threads.run([&](int tid) {
+            std::mt19937_64 mt(bench.seed + tid);
+            for (int i = 0; i < n / t; ++i) {
+              std::uint64_t r{mt()};
+              int k(r >> 33), op(r % 100);
+              if (op >= writes)
+                keep(s->search(k));
+              else if (op % 2)
+                s->insert(k, k);
+              else
+                s->remove(k);
+            }
+          });
+        },
+        [](std::unique_ptr<Map> &) { return true; });
+  };
+  mixed.operator()<ConcurrentHashST<int, int>>("ConcurrentHashST<95/5>", 5,
+                                               pool);
+  mixed.operator()<ConcurrentHashST<int, int>>("ConcurrentHashST<80/20>", 20,
+                                               pool);
+  mixed.operator()<ConcurrentHashST<int, int>>("ConcurrentHashST<50/50>", 50,
+                                               pool);
+  mixed.operator()<ConcurrentHashST<int, int>>(
+      "ConcurrentHashST<95/5, serial>", 5, serial);
+  mixed.operator()<ConcurrentHashST<int, int>>(
+      "ConcurrentHashST<50/50, serial>", 50, serial);
+  mixed.operator()<Locked>("shared_mutex<95/5>", 5, pool);
+  mixed.operator()<Locked>("shared_mutex<50/50>", 50, pool);
+}
+#else
 int main() {
   SequentialSearchST<int, int> st;
   SeparateChainingHashST<int, int> sc;
@@ -115,4 +879,135 @@ int main() {
   st.remove(1);
   sc.remove(0);
   sc.remove(1);
-}
\ No newline at end of file
+
+  // 与std::unordered_map对照随机增删查, 键集中在小范围内, 删除频繁
+  SwissHashST<int, int> sw;
+  std::unordered_map<int, int> want;
+  std::mt19937 mt(std::random_device{}());
+  for (int step = 0; step < 1 << 20; ++step) {
+    int key = mt() % (1 << 14), op = mt() % 3;
+    if (op == 0)
+      sw.insert(key, step), want[key] = step;
+    else if (op == 1)
+      sw.remove(key), want.erase(key);
+    else {
+      auto it{want.find(key)};
+      int *v{sw.search(key)};
+      assert(it == want.end() ? !v : v && *v == it->second);
+    }
+    assert(sw.size() == want.size());
+  }
+  for (auto [k, v] : want)
+    assert(*sw.search(k) == v);
+
+  // 就地构造, 已有的键不覆盖
+  SwissHashST<std::string, std::string> words;
+  assert(words.emplace("swiss", 3, 'x') && !words.emplace("swiss", "y"));
+  assert(*words.search("swiss") == "xxx" && !words.contains("chain"));
+
+  // Robin Hood表同样对照, 装载上限取0.95, 删除后段内顺序仍保持
+  RobinHoodHashST<int, int> rh(16, 0.95);
+  want.clear();
+  for (int step = 0; step < 1 << 20; ++step) {
+    int key = mt() % (1 << 14), op = mt() % 3;
+    if (op == 0)
+      rh.insert(key, step), want[key] = step;
+    else if (op == 1)
+      rh.remove(key), want.erase(key);
+    else {
+      auto it{want.find(key)};
+      int *v{rh.search(key)};
+      assert(it == want.end() ? !v : v && *v == it->second);
+    }
+    assert(rh.size() == want.size() && rh.loadFactor() <= 0.95);
+  }
+  for (auto [k, v] : want)
+    assert(*rh.search(k) == v);
+  // 字符串键经过多次翻倍后仍都能找到
+  RobinHoodHashST<std::string, std::string> names;
+  for (int i = 0; i < 5000; ++i)
+    names.insert("robin" + std::to_string(i), std::to_string(i));
+  assert(names.size() == 5000 && names.M >= 4096);
+  for (int i = 0; i < 5000; ++i)
+    assert(*names.search("robin" + std::to_string(i)) == std::to_string(i));
+  for (int i = 0; i < 5000; ++i)
+    names.remove("robin" + std::to_string(i));
+  assert(!names.contains("robin0") && names.empty());
+
+  // 批量建表, 插入, 查找与逐个操作一致; 含重复键, 后出现的值为准
+  ns::vector<int> keys(5000), vals(5000), probe(7000);
+  for (int i = 0; i < keys.size(); ++i)
+    keys[i] = mt() % 3000, vals[i] = i;
+  for (int &q : probe)
+    q = mt() % 6000;
+  SeparateChainingHashST<int, int> bulk(keys, vals), many(7);
+  many.insertMany(keys, vals);
+  SwissHashST<int, int> sw2(keys, vals), sw3;
+  sw3.insert(keys[0], -1);
+  sw3.insertMany(keys, vals);
+  want.clear();
+  for (int i = 0; i < keys.size(); ++i)
+    want[keys[i]] = vals[i];
+  // 重复键不让insertMany多扩容: 容量与逐个插入相同, 再插一遍也不变
+  SwissHashST<int, int> one;
+  for (int i = 0; i < keys.size(); ++i)
+    one.insert(keys[i], vals[i]);
+  int capacity{sw3.M};
+  sw3.insertMany(keys, vals);
+  assert(sw3.M == one.M && sw3.M == capacity);
+  std::sort(keys.begin(), keys.end());
+  SeparateChainingHashST<int, int> sorted(keys, keys, true);
+  assert(bulk.size() == want.size() && many.size() == want.size());
+  assert(sorted.size() == want.size());
+  assert(sw2.size() == want.size() && sw3.size() == want.size());
+  ns::vector<SeparateChainingHashST<int, int>::Node *> nodes(probe.size());
+  ns::vector<int *> found(probe.size());
+  bulk.searchMany(probe, nodes);
+  sw2.searchMany(probe, found);
+  for (int i = 0; i < probe.size(); ++i) {
+    auto it{want.find(probe[i])};
+    bool hit{it != want.end()};
+    assert(bool(nodes[i]) == hit && bool(found[i]) == hit);
+    assert(!hit || (nodes[i]->val == it->second && *found[i] == it->second));
+    assert(bool(many.search(probe[i])) == hit);
+    assert(bool(sorted.search(probe[i])) == hit);
+    int *v{sw3.search(probe[i])};
+    assert(hit ? v && *v == it->second : !v);
+  }
+
+  // 4个线程并发写入不同的键, 之后0号线程反复增删使分片不断重建,
+  // 其余线程同时读: 读到的值总与键对应, 从未删除的键总能读到
+  ConcurrentHashST<int, long> cc;
+  ThreadPool pool(4);
+  constexpr int K{1 << 15};
+  pool.run([&](int tid) {
+    for (int k = tid; k < K; k += 4)
+      cc.insert(k, 3L * k);
+  });
+  assert(cc.size() == K);
+  std::atomic<bool> done{false};
+  pool.run([&](int tid) {
+    if (tid == 0) {
+      for (int round = 0; round < 4; ++round) {
+        for (int k = 1; k < K; k += 2)
+          cc.remove(k);
+        for (int k = K; k < 2 * K; ++k)
+          cc.insert(k, 3L * k);
+        for (int k = 1; k < K; k += 2)
+          cc.insert(k, 3L * k);
+        for (int k = K; k < 2 * K; ++k)
+          cc.remove(k);
+      }
+      done = true;
+    } else
+      while (!done)
+        for (int k = tid; k < 2 * K; k += 7) {
+          auto v{cc.search(k)};
+          assert(!v || *v == 3L * k);
+          assert(v || k >= K || k % 2);
+        }
+  });
+  assert(cc.size() == K && !cc.contains(K));
+  assert(*cc.search(K - 1) == 3L * (K - 1));
+}
+#endif
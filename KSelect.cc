@@ -1,40 +1,231 @@
-#include "vector.hh"
-#include <algorithm>
-#include <concepts>
+#include "SortQuick.hh"
+#include <cassert>
+#include <cmath>
 #include <print>
 #include <random>
 
+/**
+ * 就地选择, 使A[k]为第k小, 其左都不大于它, 其右都不小于它
+ *   大区间用Floyd-Rivest: 先在k附近取约n^(2/3)个元素递归选出A[k],
+ *   以它为枢轴, 切分后k几乎总落在很窄的一侧; 小区间九数取中
+ *   三向切分, 大量重复元素一次归入等于区间
+ *   切分累计扫过4n个元素仍未结束时改用中位数的中位数取枢轴, 保证线性
+ */
 template <typename compar>
   requires std::totally_ordered<compar>
 struct QuickSelect {
-  static compar select(ns::vector<compar> a, int key) {
-    std::ranges::shuffle(a, std::mt19937(std::random_device{}()));
-    int lo = 0, hi = a.size() - 1;
-    while (lo < hi) {
-      int pivot = partition(a, lo, hi);
-      if (pivot == key)
-        return a[key];
-      else if (pivot > key)
-        hi = pivot - 1;
-      else if (pivot < key)
-        lo = pivot + 1;
+  using Quick = Quick3way<compar, Partition::block>;
+  using Intro = IntroSort<compar, Partition::block>;
+  static constexpr int sample{600}, cutoff{16};
+
+  static compar select(ns::vector<compar> &A, int k) {
+    select(A, 0, A.size() - 1, k);
+    return A[k];
+  }
+
+  static void select(ns::vector<compar> &A, int lo, int hi, int k) {
+    long budget{4L * (hi - lo + 1)};
+    while (hi - lo + 1 > cutoff) {
+      int n{hi - lo + 1}, p;
+      if ((budget -= n) < 0)
+        p = medianOfMedians(A, lo, hi);
+      else if (n > sample) {
+        // 样本区间按k在[lo, hi]中的相对位置偏移, 第k小以高概率落在其中
+        double z{std::log(double(n))}, s{0.5 * std::exp(2 * z / 3)};
+        double i{double(k - lo + 1)};
+        double sd{0.5 * std::sqrt(z * s * (n - s) / n)};
+        if (i < n / 2)
+          sd = -sd;
+        int l{std::max(lo, int(k - i * s / n + sd))};
+        int h{std::min(hi, int(k + (n - i) * s / n + sd))};
+        select(A, l, h, k);
+        p = k;
+      } else
+        p = Intro::pivot(A, lo, hi);
+      std::swap(A[lo], A[p]);
+      auto [lt, gt]{Quick::partition(A, lo, hi)};
+      if (k < lt)
+        hi = lt - 1;
+      else if (k > gt)
+        lo = gt + 1;
+      else
+        return;
     }
-    return a[key];
-  }
-  static int partition(ns::vector<compar> &A, int p, int r) {
-    compar x = A[r];
-    int i = p - 1;
-    for (int j = p; j < r; ++j) {
-      if (A[j] <= x) {
-        ++i;
-        std::swap(A[i], A[j]);
-      }
+    insertion(A, lo, hi);
+  }
+
+  // 每5个一组, 组中位数移到区间前部, 再选出它们的中位数, 返回其下标
+  static int medianOfMedians(ns::vector<compar> &A, int lo, int hi) {
+    int g{lo};
+    for (int i = lo; i <= hi; i += 5, ++g) {
+      int r{std::min(i + 4, hi)};
+      insertion(A, i, r);
+      std::swap(A[g], A[i + (r - i) / 2]);
+    }
+    int mid{lo + (g - lo - 1) / 2};
+    select(A, lo, g - 1, mid);
+    return mid;
+  }
+
+  /**
+   * 一次选出多个顺序统计量, 每个k都满足select的性质
+   *   先选中间的k, 左右两半的k各自只在k的一侧递归, 共O(n log m)
+   */
+  static void selectMany(ns::vector<compar> &A, ns::vector<int> ks) {
+    std::sort(ks.begin(), ks.end());
+    int m{int(std::unique(ks.begin(), ks.end()) - ks.begin())};
+    many(A, 0, A.size() - 1, ks, 0, m - 1);
+  }
+  static void many(ns::vector<compar> &A, int lo, int hi,
+                   const ns::vector<int> &ks, int a, int b) {
+    if (a > b || lo >= hi)
+      return;
+    int m{a + (b - a) / 2}, k{ks[m]};
+    select(A, lo, hi, k);
+    many(A, lo, k - 1, ks, a, m - 1);
+    many(A, k + 1, hi, ks, m + 1, b);
+  }
+
+  // 百分位数, p在[0, 1]内, 取下标round(p * (n - 1))
+  // A为空时没有百分位数, 返回空
+  static ns::vector<compar> percentiles(ns::vector<compar> &A,
+                                        const ns::vector<double> &ps) {
+    if (A.empty())
+      return {};
+    ns::vector<int> ks(ps.size());
+    for (int i = 0; i < ps.size(); ++i)
+      ks[i] = std::lround(std::clamp(ps[i], 0.0, 1.0) * (A.size() - 1));
+    selectMany(A, ks);
+    ns::vector<compar> out(ps.size());
+    for (int i = 0; i < ps.size(); ++i)
+      out[i] = A[ks[i]];
+    return out;
+  }
+
+  /**
+   * 最小的k个按序放到A[0, k), 其余元素顺序任意
+   *   多线程且k远小于n时, 每个线程先在自己那段选出最小的k个,
+   *   t*k个候选集中到A前部后再选一次; 最后并行内省排序A[0, k)
+   */
+  static void partialSort(ns::vector<compar> &A, int k,
+                          ThreadPool &pool = ThreadPool::global()) {
+    int n{A.size()}, t{pool.size()};
+    k = std::clamp(k, 0, n);
+    if (k == 0)
+      return;
+    if (t > 1 && n >= (1 << 16) && 4L * k * t <= n) {
+      ns::vector<int> bound(t + 1);
+      for (int i = 0; i <= t; ++i)
+        bound[i] = long(n) * i / t;
+      pool.run([&](int i) {
+        select(A, bound[i], bound[i + 1] - 1, bound[i] + k - 1);
+      });
+      // 每段长至少4k, 第i段的候选与A[i*k, (i+1)*k)不重叠
+      for (int i = 1; i < t; ++i)
+        std::swap_ranges(&A[bound[i]], &A[bound[i]] + k, &A[i * k]);
+      n = t * k;
     }
-    std::swap(A[i + 1], A[r]);
-    return i + 1;
+    if (k < n)
+      select(A, 0, n - 1, k - 1);
+    Intro::sort(A, 0, k - 1, pool);
   }
 };
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  struct State {
+    ns::vector<int> A;
+    int k, want;
+  };
+  // 选中位数, 与std::nth_element比较
+  auto select = [&](std::string_view name, auto f) {
+    bench.bulk(
+        "select", name,
+        [&](int n, Dist d) {
+          State s{benchData(d, n, bench.seed), n / 2, 0};
+          ns::vector<int> B(s.A);
+          std::nth_element(B.begin(), B.begin() + s.k, B.end());
+          s.want = B[s.k];
+          return s;
+        },
+        [&](State &s) { f(s.A, s.k); },
+        [](State &s) { return s.A[s.k] == s.want; });
+  };
+  select("QuickSelect", [](auto &A, int k) { QuickSelect<int>::select(A, k); });
+  select("std::nth_element", [](auto &A, int k) {
+    std::nth_element(A.begin(), A.begin() + k, A.end());
+  });
+
+  // 一次求99个百分位数, 对照先整体排序
+  ns::vector<double> ps(99);
+  for (int i = 0; i < 99; ++i)
+    ps[i] = (i + 1) / 100.0;
+  struct Quantiles {
+    ns::vector<int> A, want, got;
+  };
+  auto quantiles = [&](std::string_view name, auto f) {
+    bench.bulk(
+        "percentiles", name,
+        [&](int n, Dist d) {
+          Quantiles s{benchData(d, n, bench.seed), {}, {}};
+          ns::vector<int> B(s.A);
+          std::sort(B.begin(), B.end());
+          s.want = ns::vector<int>(ps.size());
+          for (int i = 0; i < ps.size(); ++i)
+            s.want[i] = B[std::lround(ps[i] * (n - 1))];
+          return s;
+        },
+        [&](Quantiles &s) { s.got = f(s.A); },
+        [](Quantiles &s) {
+          return std::equal(s.got.begin(), s.got.end(), s.want.begin(),
+                            s.want.end());
+        });
+  };
+  quantiles("QuickSelect",
+            [&](auto &A) { return QuickSelect<int>::percentiles(A, ps); });
+  quantiles("std::sort", [&](auto &A) {
+    std::sort(A.begin(), A.end());
+    ns::vector<int> got(ps.size());
+    for (int i = 0; i < ps.size(); ++i)
+      got[i] = A[std::lround(ps[i] * (A.size() - 1))];
+    return got;
+  });
+
+  // 前n/100个, 只检查前缀
+  auto partial = [&](std::string_view name, auto f) {
+    bench.bulk(
+        "partialSort", name,
+        [&](int n, Dist d) { return benchData(d, n, bench.seed); },
+        [&](ns::vector<int> &A) { f(A, std::max(1, A.size() / 100)); },
+        [](ns::vector<int> &A) {
+          int k{std::max(1, A.size() / 100)};
+          return std::is_sorted(A.begin(), A.begin() + k) &&
+                 std::all_of(A.begin() + k, A.end(),
+                             [&](int x) { return A[k - 1] <= x; });
+        });
+  };
+  partial("QuickSelect",
+          [](auto &A, int k) { QuickSelect<int>::partialSort(A, k); });
+  ThreadPool serial(1);
+  partial("QuickSelect<serial>", [&](auto &A, int k) {
+    QuickSelect<int>::partialSort(A, k, serial);
+  });
+  partial("std::partial_sort", [](auto &A, int k) {
+    std::partial_sort(A.begin(), A.begin() + k, A.end());
+  });
+}
+#else
+// A[k]为第k小, 且左右两侧已分开
+template <class T> bool selected(const ns::vector<T> &A, int k, T want) {
+  auto below = [&](T x) { return x <= want; };
+  auto above = [&](T x) { return want <= x; };
+  return A[k] == want && std::all_of(A.begin(), A.begin() + k, below) &&
+         std::all_of(A.begin() + k, A.end(), above);
+}
+
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -50,7 +241,61 @@ int main() {
   }
   std::print("\n\n");
 
+  // 一次选出全部12个
+  QuickSelect<int>::selectMany(a, {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
   for (int i = 0; i < 12; ++i)
-    std::print("{}\t", QuickSelect<int>::select(a, i));
+    std::print("{}\t", a[i]);
   std::print("\n");
-}
\ No newline at end of file
+  assert(std::ranges::is_sorted(a));
+
+  // 随机, 有序, 逆序, 少量不同值, 全部相同, 管风琴
+  ThreadPool pool(4);
+  for (int n : {1, 2, 17, 600, 601, 5000, 1 << 17, 1 << 20})
+    for (int shape = 0; shape < 6; ++shape) {
+      ns::vector<int> A(n);
+      for (int i = 0; i < n; ++i)
+        A[i] = shape == 0   ? int(mt())
+               : shape == 1 ? i
+               : shape == 2 ? n - i
+               : shape == 3 ? int(mt() % 4)
+               : shape == 4 ? 7
+                            : std::min(i, n - i);
+      ns::vector<int> want(A);
+      std::sort(want.begin(), want.end());
+
+      for (int k : {0, n / 3, n / 2, n - 1}) {
+        ns::vector<int> B(A);
+        assert(QuickSelect<int>::select(B, k) == want[k]);
+        assert(selected(B, k, want[k]));
+      }
+
+      ns::vector<int> ks{n - 1, 0, n / 10, n / 10, n / 2, int(n * 99L / 100)};
+      ns::vector<int> B(A);
+      QuickSelect<int>::selectMany(B, ks);
+      for (int k : ks)
+        assert(selected(B, k, want[k]));
+
+      // 中位数的中位数至少大于3/10, 小于3/10的元素
+      B = A;
+      int p{QuickSelect<int>::medianOfMedians(B, 0, n - 1)};
+      auto [first, last]{std::equal_range(want.begin(), want.end(), B[p])};
+      assert(n < 50 || (first < want.begin() + n * 7 / 10 &&
+                        last > want.begin() + n * 3 / 10));
+
+      for (int k : {1, std::min(10, n), n / 100, n / 2, n}) {
+        B = A;
+        QuickSelect<int>::partialSort(B, k, pool);
+        assert(std::equal(B.begin(), B.begin() + k, want.begin()));
+      }
+    }
+
+  ns::vector<double> D(100001);
+  for (int i = 0; i < D.size(); ++i)
+    D[i] = i / 1000.0;
+  std::ranges::shuffle(D, mt);
+  auto q{QuickSelect<double>::percentiles(D, {0.5, 0.99, 0, 1, 0.25})};
+  assert(q[0] == 50 && q[1] == 99 && q[2] == 0 && q[3] == 100 && q[4] == 25);
+  ns::vector<double> none;
+  assert(QuickSelect<double>::percentiles(none, {0.5, 1}).empty());
+}
+#endif
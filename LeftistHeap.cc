@@ -95,6 +95,32 @@ struct LeftistHeap {
   }
 };
 
+#ifdef BENCH
+#include "Bench.hh"
+
+// 插入n个再全部取出
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  struct State {
+    ns::vector<int> A, out;
+  };
+  bench.bulk(
+      "heap", "LeftistHeap",
+      [&](int n, Dist d) { return State{benchData(d, n, bench.seed), {}}; },
+      [](State &s) {
+        // comparator(a, b)为真时b作根
+        LeftistHeap<int, std::less<int>> maxpq(std::less<int>{});
+        for (int e : s.A)
+          maxpq.insert(e);
+        s.out.reserve(s.A.size());
+        while (!maxpq.empty())
+          s.out.push_back(maxpq.delMax());
+      },
+      [](State &s) {
+        return std::is_sorted(s.out.begin(), s.out.end(), std::greater<int>{});
+      });
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -122,4 +148,5 @@ int main() {
     assert(maxpq.isLeftistHeap());
   }
   std::print("\n");
-}
\ No newline at end of file
+}
+#endif
@@ -1,16 +1,20 @@
-#include "Graph.hh"
+#include "CSR.hh"
 #include "PQ.hh"
 #include "UF.hh"
+#include <string>
 
 struct BoruvkaMST {
   ns::deque<Edge> mst;
   int wt{0};
 
-  BoruvkaMST(const EdgeWeightedGraph &G) {
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedGraph>
+  BoruvkaMST(const T &G) {
     UF uf(G.V);
     for (int t = 1; t < G.V && mst.size() < G.V - 1; t += t) {
       ns::deque<const Edge *> closest(G.V, nullptr);
-      for (const auto &e : G.edges()) {
+      ns::deque<Edge> edges{G.edges()};
+      for (const auto &e : edges) {
         int v{e.v}, w{e.w};
         int i{uf.find(v)}, j{uf.find(w)};
         if (i == j)
@@ -27,7 +31,7 @@ struct BoruvkaMST {
           if (uf.find(v) != uf.find(w)) {
             mst.push_back(*e);
             wt += e->weight;
-            uf.join(v, w);
+            uf.merge(v, w);
           }
         }
       }
@@ -42,7 +46,9 @@ struct KruskalMST {
   int wt{0};
   ns::deque<Edge> mst;
 
-  KruskalMST(const EdgeWeightedGraph &G) {
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedGraph>
+  KruskalMST(const T &G) {
     MinPQ<Edge> pq(G.edges());
     UF uf(G.V);
     while (!pq.empty() && mst.size() < G.V - 1) {
@@ -60,20 +66,22 @@ struct KruskalMST {
 };
 
 // priority first search minimun spanning forest
-struct PrimMST {
+template <class IndexPQ = IndexMinPQ<int>> struct PrimMST {
   ns::deque<Edge *> edgeTo;
   ns::deque<int> distTo;
   ns::deque<bool> marked;
-  IndexMinPQ<int> pq;
+  IndexPQ pq;
 
-  PrimMST(const EdgeWeightedGraph &G)
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedGraph>
+  PrimMST(const T &G)
       : edgeTo(G.V, nullptr), distTo(G.V, 0xffff), marked(G.V, false), pq(G.V) {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v])
         search(G, v);
   }
 
-  void search(const EdgeWeightedGraph &G, int s) {
+  template <class T> void search(const T &G, int s) {
     distTo[s] = 0;
     pq.insert(s, distTo[s]);
     while (!pq.empty()) {
@@ -82,7 +90,7 @@ struct PrimMST {
     }
   }
 
-  void scan(const EdgeWeightedGraph &G, int v) {
+  template <class T> void scan(const T &G, int v) {
     marked[v] = true;
     for (const auto &e : G.adj[v]) {
       int w{e.other(v)};
@@ -127,12 +135,22 @@ struct LazyPrimMST {
   ns::deque<bool> marked;
   MinPQ<Edge> pq;
 
-  LazyPrimMST(const EdgeWeightedGraph &G) : wt{0}, marked(G.V, false), pq(G.V) {
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedGraph>
+  LazyPrimMST(const T &G) : wt{0}, marked(G.V, false), pq(capacity(G)) {
     for (int v = 0; v < G.V; ++v)
       if (!marked[v])
         search(G, v);
   }
-  void search(const EdgeWeightedGraph &G, int s) {
+  // 每条边至多入队一次, 容量取邻接表总长
+  template <class T> static int capacity(const T &G) {
+    if constexpr (std::is_same_v<T, EdgeWeightedGraph>)
+      return CSR<T>::count(G);
+    else
+      return G.E;
+  }
+
+  template <class T> void search(const T &G, int s) {
     scan(G, s);
     while (!pq.empty()) {
       Edge e{pq.delMin()};
@@ -148,7 +166,7 @@ struct LazyPrimMST {
     }
   }
 
-  void scan(const EdgeWeightedGraph &G, int v) {
+  template <class T> void scan(const T &G, int v) {
     marked[v] = true;
     for (const auto &e : G.adj[v])
       if (!marked[e.other(v)])
@@ -166,6 +184,39 @@ template <class MST> void printMST(const MST &mst) {
   std::print("\nweight\t{}\n", mst.weight());
 }
 
+#ifdef BENCH
+#include "Bench.hh"
+#include "GraphGen.hh"
+
+// 各算法的总权重与Kruskal一致
+template <class MST>
+void benchMST(Bench &bench, std::string_view name, std::string_view input,
+              const CSR<EdgeWeightedGraph> &G, int weight) {
+  if (bench.selected("mst", name))
+    bench.measure(
+        "mst", name, G.E, input, [] { return std::optional<MST>{}; },
+        [&](std::optional<MST> &mst) { mst.emplace(G); },
+        [&](std::optional<MST> &mst) { return mst->weight() == weight; });
+}
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  for (int n : bench.sizes)
+    for (std::string_view input : bench.graphs) {
+      auto L{generateByName(input, n, bench.seed, false)};
+      if (!L)
+        Bench::usage(argv[0]);
+      CSR<EdgeWeightedGraph> G{toCSR<EdgeWeightedGraph>(*L)};
+      int weight{KruskalMST(G).weight()};
+      benchMST<KruskalMST>(bench, "KruskalMST", input, G, weight);
+      benchMST<BoruvkaMST>(bench, "BoruvkaMST", input, G, weight);
+      benchMST<PrimMST<>>(bench, "PrimMST<IndexMinPQ>", input, G, weight);
+      benchMST<PrimMST<DaryIndexMinPQ<int>>>(bench, "PrimMST<DaryIndexMinPQ<4>>",
+                                             input, G, weight);
+      benchMST<LazyPrimMST>(bench, "LazyPrimMST", input, G, weight);
+    }
+}
+#else
 int main() {
   constexpr int v{8}, e{8};
   for (int k = 0; k < 16; k++) {
@@ -197,5 +248,35 @@ int main() {
     printMST(LPMST);
     std::print("\n");
     assert(PMST.weight() == LPMST.weight());
+
+    CSR<EdgeWeightedGraph> csr(EWG);
+    assert(BoruvkaMST(csr).weight() == KMST.weight());
+    assert(KruskalMST(csr).weight() == KMST.weight());
+    assert(PrimMST(csr).weight() == KMST.weight());
+    assert(LazyPrimMST(csr).weight() == KMST.weight());
+    PrimMST<DaryIndexMinPQ<int, 4>> P4MST(csr);
+    PrimMST<DaryIndexMinPQ<int, 8>> P8MST(EWG);
+    assert(P4MST.weight() == KMST.weight() && P8MST.weight() == KMST.weight());
+    PrimMST<DialIndexMinPQ<7>> BPMST(EWG);
+    assert(BPMST.weight() == KMST.weight());
+
+    // 四叉堆建堆后逐个取出与二叉堆一致
+    MinPQ<Edge> bpq(EWG.edges());
+    DaryMinPQ<Edge, 4> dpq(EWG.edges());
+    while (!bpq.empty())
+      assert(bpq.delMin().weight == dpq.delMin().weight);
+    assert(dpq.empty());
+
+    // 非平凡元素, 未取出的在析构时销毁
+    DaryMinPQ<std::string, 4> spq(64);
+    for (int i = 63; i >= 0; --i)
+      spq.insert(std::string(40, char('a' + i % 26)) + std::to_string(i));
+    assert(spq.delMin().starts_with(std::string(40, 'a')));
+    // 取空时最后一个元素不能被自移动冲掉
+    std::string last;
+    while (!spq.empty())
+      last = spq.delMin();
+    assert(last == std::string(40, 'z') + "51");
   }
 }
+#endif
@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <fcntl.h>
+#include <optional>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+/**
+ * 二进制文件格式的公共部分: 按64字节对齐分段写入, 只读mmap整个文件加载
+ *   各格式只管自己的Header和检查, 见GraphFile.hh, PerfectHash.hh
+ */
+
+inline std::uint64_t alignUp(std::uint64_t n) { return (n + 63) / 64 * 64; }
+
+// 各段依次写到给定偏移, 中间补0; 任何一步失败后续不再写, close返回false
+struct AlignedWriter {
+  std::FILE *f;
+  std::uint64_t at{0};
+  bool ok;
+
+  explicit AlignedWriter(const char *path)
+      : f{std::fopen(path, "wb")}, ok{f != nullptr} {}
+  AlignedWriter(const AlignedWriter &) = delete;
+  AlignedWriter &operator=(const AlignedWriter &) = delete;
+  ~AlignedWriter() {
+    if (f)
+      std::fclose(f);
+  }
+
+  AlignedWriter &put(std::uint64_t to, const void *p, std::size_t n) {
+    static constexpr char zero[64]{};
+    ok = ok && to >= at && std::fwrite(zero, 1, to - at, f) == to - at &&
+         std::fwrite(p, 1, n, f) == n;
+    at = to + n;
+    return *this;
+  }
+  bool close() {
+    bool closed{f && std::fclose(f) == 0};
+    f = nullptr;
+    return closed && ok;
+  }
+};
+
+// 只读映射整个文件, 析构时解除; 默认构造的为空, 表示不借用映射
+struct MappedFile {
+  void *base{nullptr};
+  std::size_t length{0};
+
+  MappedFile() {}
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other)
+      : base{std::exchange(other.base, nullptr)},
+        length{std::exchange(other.length, 0)} {}
+  ~MappedFile() {
+    if (base)
+      ::munmap(base, length);
+  }
+
+  // 文件不存在或短于minLength时返回空
+  static std::optional<MappedFile> open(const char *path,
+                                        std::size_t minLength) {
+    int fd{::open(path, O_RDONLY)};
+    if (fd < 0)
+      return std::nullopt;
+    struct stat st;
+    std::size_t length{::fstat(fd, &st) == 0 ? std::size_t(st.st_size) : 0};
+    void *base{length >= minLength
+                   ? ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0)
+                   : MAP_FAILED};
+    ::close(fd);
+    if (base == MAP_FAILED)
+      return std::nullopt;
+    std::optional<MappedFile> file{std::in_place};
+    file->base = base, file->length = length;
+    return file;
+  }
+
+  explicit operator bool() const { return base; }
+  template <class T> const T *at(std::uint64_t off) const {
+    return reinterpret_cast<const T *>(static_cast<const char *>(base) + off);
+  }
+  // 检查通过, 确定要用时再预读
+  void willNeed() const { ::madvise(base, length, MADV_WILLNEED); }
+};
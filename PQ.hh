@@ -1,7 +1,11 @@
 #pragma once
 #include "deque.hh"
+#include <bit>
 #include <cassert>
 #include <concepts>
+#include <memory>
+#include <new>
+#include <type_traits>
 
 /**
  *     k/2
@@ -180,6 +184,374 @@ struct IndexMinPQ {
   }
 };
 
+/**
+ * d叉堆, 0起下标
+ *        (k-1)/d
+ *           |
+ *           k
+ *     /    ...    \
+ *   dk+1   ...   dk+d
+ * 数组整体偏移d-1格, 孩子dk+1..dk+d从d(k+1)格开始, 同一节点的孩子共享缓存行
+ */
+
+// 64字节对齐的n个值初始化的元素, 与alignedFree配对
+template <class T> T *alignedNew(int n) {
+  T *p{static_cast<T *>(::operator new(sizeof(T) * n, std::align_val_t{64}))};
+  std::uninitialized_value_construct_n(p, n);
+  return p;
+}
+template <class T> void alignedFree(T *p, int n) {
+  std::destroy_n(p, n);
+  ::operator delete(p, std::align_val_t{64});
+}
+
+template <typename T, int D = 4>
+  requires std::totally_ordered<T> && (D >= 2)
+struct DaryMinPQ {
+  T *buf;
+  T *pq;
+  int maxN;
+  int n;
+
+  DaryMinPQ(int maxN)
+      : buf{alignedNew<T>(maxN + D)}, pq{buf + D - 1},
+        maxN{maxN}, n{0} {}
+
+  DaryMinPQ(const ns::deque<T> &deck) : DaryMinPQ(deck.size()) {
+    n = deck.size();
+    for (int i = 0; i < n; i++)
+      pq[i] = deck[i];
+    for (int k = (n - 2) / D; k >= 0; k--)
+      sink(k);
+    assert(isMinHeap());
+  }
+
+  ~DaryMinPQ() { alignedFree(buf, maxN + D); }
+
+  bool empty() const { return n == 0; }
+
+  void insert(T e) {
+    assert(n < maxN);
+    pq[n] = e;
+    swim(n++);
+    assert(isMinHeap());
+  }
+
+  T delMin() {
+    assert(n > 0);
+    T min{std::move(pq[0])};
+    if (--n > 0) {
+      pq[0] = std::move(pq[n]);
+      sink(0);
+    }
+    assert(isMinHeap());
+    return min;
+  }
+
+  // 空位上浮下沉, 每层一次移动
+  void swim(int k) {
+    T x{std::move(pq[k])};
+    for (int p; k > 0 && pq[p = (k - 1) / D] > x; k = p)
+      pq[k] = std::move(pq[p]);
+    pq[k] = std::move(x);
+  }
+
+  void sink(int k) {
+    T x{std::move(pq[k])};
+    for (int c; (c = D * k + 1) < n;) {
+      int j{c};
+      for (int i = c + 1, end = std::min(c + D, n); i < end; i++)
+        if (pq[i] < pq[j])
+          j = i;
+      if (!(pq[j] < x))
+        break;
+      pq[k] = std::move(pq[j]);
+      k = j;
+    }
+    pq[k] = std::move(x);
+  }
+
+  bool isMinHeap() const {
+    for (int i = 1; i < n; i++)
+      if (pq[(i - 1) / D] > pq[i])
+        return false;
+    return true;
+  }
+};
+
+// 键与下标同存于堆中, 比较时不再经keys[pq[i]]间接访问
+template <typename T, int D = 4>
+  requires std::totally_ordered<T> && (D >= 2)
+struct DaryIndexMinPQ {
+  struct Node {
+    T key;
+    int i;
+  };
+  Node *buf;
+  Node *pq;
+  int *qp;
+  int maxN;
+  int n;
+
+  DaryIndexMinPQ(int maxN)
+      : buf{alignedNew<Node>(maxN + D)}, pq{buf + D - 1},
+        qp{new int[maxN + 1]}, maxN{maxN}, n{0} {
+    for (int i = 0; i <= maxN; i++)
+      qp[i] = -1;
+  }
+
+  ~DaryIndexMinPQ() {
+    alignedFree(buf, maxN + D);
+    delete[] qp;
+  }
+
+  bool empty() const { return n == 0; }
+  bool contains(int i) const { return qp[i] != -1; }
+
+  void insert(int i, T key) {
+    assert(n < maxN && !contains(i));
+    pq[n] = {key, i};
+    qp[i] = n;
+    swim(n++);
+    assert(isMinHeap());
+  }
+
+  int delMin() {
+    assert(n > 0);
+    int min{pq[0].i};
+    qp[min] = -1;
+    if (--n > 0) {
+      pq[0] = std::move(pq[n]);
+      qp[pq[0].i] = 0;
+      sink(0);
+    }
+    assert(isMinHeap());
+    return min;
+  }
+
+  void decreaseKey(int i, T key) {
+    pq[qp[i]].key = key;
+    swim(qp[i]);
+  }
+
+  void increaseKey(int i, T key) {
+    pq[qp[i]].key = key;
+    sink(qp[i]);
+  }
+
+  void swim(int k) {
+    Node x{std::move(pq[k])};
+    for (int p; k > 0 && pq[p = (k - 1) / D].key > x.key; k = p) {
+      pq[k] = std::move(pq[p]);
+      qp[pq[k].i] = k;
+    }
+    pq[k] = std::move(x);
+    qp[pq[k].i] = k;
+  }
+
+  void sink(int k) {
+    Node x{std::move(pq[k])};
+    for (int c; (c = D * k + 1) < n;) {
+      int j{c};
+      for (int i = c + 1, end = std::min(c + D, n); i < end; i++)
+        if (pq[i].key < pq[j].key)
+          j = i;
+      if (!(pq[j].key < x.key))
+        break;
+      pq[k] = std::move(pq[j]);
+      qp[pq[k].i] = k;
+      k = j;
+    }
+    pq[k] = std::move(x);
+    qp[pq[k].i] = k;
+  }
+
+  bool isMinHeap() const {
+    for (int i = 1; i < n; i++)
+      if (pq[(i - 1) / D].key > pq[i].key || qp[pq[i].i] != i)
+        return false;
+    return true;
+  }
+};
+
+// 单调基数堆, 取出的键不减, 插入的键不小于上次取出的键last
+// 键按与last最高不同位分桶, 桶0存等于last的键, 各桶是下标上的双链表
+template <typename T = int>
+  requires std::integral<T>
+struct RadixIndexMinPQ {
+  using U = std::make_unsigned_t<T>;
+  static constexpr int B{sizeof(T) * 8 + 1};
+  T *keys;
+  int *next, *prev, *bucket;
+  int head[B];
+  int maxN;
+  int n;
+  T last;
+
+  RadixIndexMinPQ(int maxN)
+      : keys{new T[maxN + 1]}, next{new int[maxN + 1]},
+        prev{new int[maxN + 1]}, bucket{new int[maxN + 1]}, maxN{maxN}, n{0},
+        last{0} {
+    for (int i = 0; i <= maxN; i++)
+      bucket[i] = -1;
+    for (int b = 0; b < B; b++)
+      head[b] = -1;
+  }
+
+  ~RadixIndexMinPQ() {
+    delete[] keys;
+    delete[] next;
+    delete[] prev;
+    delete[] bucket;
+  }
+
+  bool empty() const { return n == 0; }
+  bool contains(int i) const { return bucket[i] != -1; }
+
+  int slot(T key) const {
+    return key == last ? 0 : std::bit_width(U(key) ^ U(last));
+  }
+
+  void link(int i, int b) {
+    bucket[i] = b, prev[i] = -1, next[i] = head[b];
+    if (head[b] != -1)
+      prev[head[b]] = i;
+    head[b] = i;
+  }
+
+  void unlink(int i) {
+    int b{bucket[i]};
+    if (prev[i] != -1)
+      next[prev[i]] = next[i];
+    else
+      head[b] = next[i];
+    if (next[i] != -1)
+      prev[next[i]] = prev[i];
+    bucket[i] = -1;
+  }
+
+  void insert(int i, T key) {
+    assert(n < maxN && !contains(i) && key >= last);
+    keys[i] = key;
+    link(i, slot(key));
+    n++;
+  }
+
+  void decreaseKey(int i, T key) {
+    assert(contains(i) && key >= last);
+    unlink(i);
+    keys[i] = key;
+    link(i, slot(key));
+  }
+
+  void increaseKey(int i, T key) { decreaseKey(i, key); }
+
+  // 桶0空时取最低非空桶的最小键为新last, 该桶元素全部落入更低的桶
+  int delMin() {
+    assert(n > 0);
+    if (head[0] == -1) {
+      int b{1};
+      while (head[b] == -1)
+        b++;
+      T min{keys[head[b]]};
+      for (int x = head[b]; x != -1; x = next[x])
+        min = std::min(min, keys[x]);
+      last = min;
+      for (int x = head[b], y; x != -1; x = y) {
+        y = next[x];
+        link(x, slot(keys[x]));
+      }
+      head[b] = -1;
+    }
+    int min{head[0]};
+    unlink(min);
+    n--;
+    return min;
+  }
+};
+
+// Dial桶队列, 要求队中键的极差不超过C
+// 键k放入环形桶k%(C+1), cur是最小键的下界
+// 插入比cur小的键时下移cur, 因此Prim这类不单调的键也适用
+template <int C>
+  requires(C >= 1)
+struct DialIndexMinPQ {
+  int *keys;
+  int *next, *prev, *bucket;
+  int head[C + 1];
+  int maxN;
+  int n;
+  int cur;
+
+  DialIndexMinPQ(int maxN)
+      : keys{new int[maxN + 1]}, next{new int[maxN + 1]},
+        prev{new int[maxN + 1]}, bucket{new int[maxN + 1]}, maxN{maxN}, n{0},
+        cur{0} {
+    for (int i = 0; i <= maxN; i++)
+      bucket[i] = -1;
+    for (int b = 0; b <= C; b++)
+      head[b] = -1;
+  }
+
+  ~DialIndexMinPQ() {
+    delete[] keys;
+    delete[] next;
+    delete[] prev;
+    delete[] bucket;
+  }
+
+  bool empty() const { return n == 0; }
+  bool contains(int i) const { return bucket[i] != -1; }
+
+  void link(int i, int key) {
+    assert(key >= 0);
+    if (n == 0 || key < cur)
+      cur = key;
+    assert(key - cur <= C);
+    int b{key % (C + 1)};
+    keys[i] = key, bucket[i] = b, prev[i] = -1, next[i] = head[b];
+    if (head[b] != -1)
+      prev[head[b]] = i;
+    head[b] = i;
+  }
+
+  void unlink(int i) {
+    int b{bucket[i]};
+    if (prev[i] != -1)
+      next[prev[i]] = next[i];
+    else
+      head[b] = next[i];
+    if (next[i] != -1)
+      prev[next[i]] = prev[i];
+    bucket[i] = -1;
+  }
+
+  void insert(int i, int key) {
+    assert(n < maxN && !contains(i));
+    link(i, key);
+    n++;
+  }
+
+  void decreaseKey(int i, int key) {
+    assert(contains(i));
+    unlink(i);
+    n--;
+    insert(i, key);
+  }
+
+  void increaseKey(int i, int key) { decreaseKey(i, key); }
+
+  int delMin() {
+    assert(n > 0);
+    while (head[cur % (C + 1)] == -1)
+      cur++;
+    int min{head[cur % (C + 1)]};
+    unlink(min);
+    n--;
+    return min;
+  }
+};
+
 template <class T, class Comparator> struct PQ {
   T *pq;
   int n;
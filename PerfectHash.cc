@@ -0,0 +1,138 @@
+#include "PerfectHash.hh"
+#include <filesystem>
+#include <print>
+#include <random>
+#include <unordered_map>
+
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  auto tmp{std::filesystem::temp_directory_path() / "PerfectHash.bench.bin"};
+  using ST = PerfectHashST<int, int>;
+
+  bench.bulk(
+      "map.build", "PerfectHashST",
+      [&](int n, Dist d) { return benchData(d, n, bench.seed); },
+      [](ns::vector<int> &keys) { keep(ST::make(keys, keys)->size()); },
+      [](ns::vector<int> &) { return true; });
+
+  // 一半命中; mmap版本先写入文件再映射回来
+  auto search = [&]<class Map>(std::string_view name, auto make) {
+    struct State {
+      std::unique_ptr<Map> st;
+      ns::vector<int> queries;
+    };
+    bench.each(
+        "map.search.static", name,
+        [&](int n, Dist d) {
+          auto keys{benchData(d, n, bench.seed)};
+          State s{make(keys), ns::vector<int>(n)};
+          std::mt19937_64 mt(bench.seed);
+          for (int &q : s.queries)
+            q = mt() % 2 ? keys[mt() % n] : int(mt() >> 33);
+          return s;
+        },
+        [](State &s, int i) {
+          if constexpr (std::is_same_v<Map, ST>)
+            keep(s.st->search(s.queries[i]));
+          else
+            keep(s.st->find(s.queries[i]) != s.st->end());
+        });
+  };
+  search.operator()<ST>("PerfectHashST", [](ns::vector<int> &keys) {
+    return std::make_unique<ST>(*ST::make(keys, keys));
+  });
+  search.operator()<ST>("PerfectHashST<mmap>", [&](ns::vector<int> &keys) {
+    if (!writePerfectHash(tmp.c_str(), *ST::make(keys, keys)))
+      std::exit(1);
+    return std::make_unique<ST>(*loadPerfectHash<int, int>(tmp.c_str()));
+  });
+  using Unordered = std::unordered_map<int, int>;
+  search.operator()<Unordered>("std::unordered_map",
+                               [](ns::vector<int> &keys) {
+                                 auto st{std::make_unique<Unordered>()};
+                                 for (int k : keys)
+                                   (*st)[k] = k;
+                                 return st;
+                               });
+  std::filesystem::remove(tmp);
+}
+#else
+int main() {
+  auto tmp{std::filesystem::temp_directory_path() / "PerfectHash.bin"};
+  const char *path{tmp.c_str()};
+  std::mt19937 mt(std::random_device{}());
+
+  // 与std::unordered_map对照, 含重复键, 后出现的值为准
+  for (int m : {0, 1, 2, 3, 100, 5000, 1 << 18}) {
+    ns::vector<int> keys(m), vals(m);
+    std::unordered_map<int, int> want;
+    for (int i = 0; i < m; ++i) {
+      keys[i] = mt() % (2 * m + 1), vals[i] = i;
+      want[keys[i]] = i;
+    }
+    auto made{PerfectHashST<int, int>::make(keys, vals)};
+    assert(made);
+    auto &st{*made};
+    assert(st.size() == want.size());
+    // 最小: n个槽恰好放下全部n个不同的键
+    std::unordered_map<int, int> left(want);
+    for (int i = 0; i < st.size(); ++i) {
+      const auto &slot{st.slots[i]};
+      assert(left.contains(slot.key) && left[slot.key] == slot.val);
+      left.erase(slot.key);
+    }
+    for (auto [k, v] : want)
+      assert(*st.search(k) == v);
+    for (int q = -m; q < 0; ++q)
+      assert(!st.contains(q));
+
+    [[maybe_unused]] bool ok{writePerfectHash(path, st)};
+    assert(ok);
+    auto mapped{loadPerfectHash<int, int>(path)};
+    assert(mapped && mapped->mapping && mapped->size() == st.size());
+    for (int q = -1; q <= 2 * m + 1; ++q)
+      assert(st.contains(q) == mapped->contains(q) &&
+             (!st.contains(q) || *st.search(q) == *mapped->search(q)));
+  }
+
+  // 64位键, 浮点值
+  ns::vector<long long> big(1000);
+  ns::vector<double> half(1000);
+  for (int i = 0; i < 1000; ++i)
+    big[i] = (long long)(mt()) << 32 | mt(), half[i] = i / 2.0;
+  auto st{*PerfectHashST<long long, double>::make(big, half)};
+  [[maybe_unused]] bool ok{writePerfectHash(path, st)};
+  assert(ok);
+  auto mapped{loadPerfectHash<long long, double>(path)};
+  for (int i = 0; i < 1000; ++i)
+    assert(*mapped->search(big[i]) == *st.search(big[i]));
+  std::print("{} keys, {} buckets, seed {}\n", st.size(), st.B, st.seed);
+
+  // NaN与自身不等但std::hash相同, 换seed也分不开; 0.0与-0.0相等, 去重
+  double nan{std::nan("")};
+  ns::vector<double> nans{nan, 1, nan}, zeros{0.0, -0.0, 1};
+  ns::vector<int> ids{0, 1, 2};
+  assert(!(PerfectHashST<double, int>::make(nans, ids)));
+  auto zero{PerfectHashST<double, int>::make(zeros, ids)};
+  assert(zero && zero->size() == 2 && *zero->search(0.0) == 1);
+
+  // 类型不符, 截断, 版本不符
+  assert(!(loadPerfectHash<int, int>(path)));
+  std::filesystem::resize_file(tmp, std::filesystem::file_size(tmp) - 4);
+  assert(!(loadPerfectHash<long long, double>(path)));
+  ok = writePerfectHash(path, st);
+  assert(ok);
+  if (std::FILE *f{std::fopen(path, "r+b")}) {
+    std::uint32_t version{PerfectHashHeader::VERSION + 1};
+    std::fseek(f, offsetof(PerfectHashHeader, version), SEEK_SET);
+    std::fwrite(&version, sizeof version, 1, f);
+    std::fclose(f);
+  }
+  assert(!(loadPerfectHash<long long, double>(path)));
+  assert(!(loadPerfectHash<int, int>("/nonexistent/PerfectHash.bin")));
+  std::filesystem::remove(tmp);
+}
+#endif
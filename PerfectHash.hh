@@ -0,0 +1,278 @@
+#pragma once
+#include "Hash.hh"
+#include "MappedFile.hh"
+#include "vector.hh"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+/**
+ * 只读静态散列表, 键集合一次建好, 之后只查不改
+ *   最小完美散列(PTHash): 键按散列值分进约6n/log2(n)个桶, 60%的键落在
+ *   前30%的桶里; 从大桶起依次为每个桶找最小的pilot, 使桶里的键经
+ *   mixHash(h ^ pilot)都落到[0, m)中尚未占用的不同位置, m约为n/0.99
+ *   留1%的余量, 最后的单键桶不必在几乎占满的表里反复试
+ *   落在[n, m)的约1%的键经remap改放到[0, n)里剩下的空位, 于是最小
+ *   值连同键按位置存进n个槽的平坦数组, 没有空槽, 没有链
+ *   查找: 一次散列定桶, 读pilot, 读一个槽比较键; pilot每键约10位, 远小于槽数组
+ *   散列值由std::hash经双射得到, 两个不同的键std::hash相同时任何seed都
+ *   分不开, make返回空; 只有pilot用尽时才换seed重建
+ * 键值须可平凡复制, 且std::hash跨进程一致, 写入文件后可直接mmap使用
+ *
+ *   [Header][pilot B][remap m-n][Slot n], 各段按64字节对齐, 本机字节序
+ */
+template <class Key, class Value>
+  requires is_hashable<Key> && std::equality_comparable<Key> &&
+           std::is_trivially_copyable_v<Key> &&
+           std::is_trivially_copyable_v<Value>
+struct PerfectHashST {
+  struct Slot {
+    Key key;
+    Value val;
+  };
+  // 散列值低32位小于它的键分进前30%的桶
+  static constexpr std::uint32_t DENSE{0x9999999a};
+  std::uint64_t seed{0};
+  // B个桶中前dense个是密集桶
+  int n{0}, m{0}, B{0}, dense{0};
+  // 自己建的数组, build经它们写入; 借用只读映射时都为空
+  struct Owned {
+    std::uint32_t *pilot;
+    int *remap;
+    Slot *slots;
+  } own{};
+  // 查找只经这组只读指针, 指向own或mapping
+  const std::uint32_t *pilot{nullptr};
+  const int *remap{nullptr};
+  const Slot *slots{nullptr};
+  // 非空时数组指向这个只读映射, 不归自己delete
+  MappedFile mapping;
+
+  enum Built { OK, RESEED, COLLISION };
+
+  PerfectHashST() {}
+
+  // 重复的键后出现的覆盖前面的
+  static std::optional<PerfectHashST> make(std::span<const Key> keys,
+                                           std::span<const Value> vals) {
+    assert(keys.size() == vals.size());
+    std::optional<PerfectHashST> st{std::in_place};
+    for (Built b; (b = st->build(keys, vals)) != OK; ++st->seed)
+      if (b == COLLISION)
+        return std::nullopt;
+    return st;
+  }
+
+  PerfectHashST(std::uint64_t seed, int n, int B, const std::uint32_t *pilot,
+                const int *remap, const Slot *slots, MappedFile mapping)
+      : seed{seed}, n{n}, m{positions(n)}, B{B}, dense{denseBuckets(B)},
+        pilot{pilot}, remap{remap}, slots{slots}, mapping{std::move(mapping)} {
+  }
+
+  PerfectHashST(const PerfectHashST &) = delete;
+  PerfectHashST &operator=(const PerfectHashST &) = delete;
+  PerfectHashST(PerfectHashST &&other)
+      : seed{other.seed}, n{other.n}, m{other.m}, B{other.B},
+        dense{other.dense}, own{std::exchange(other.own, {})},
+        pilot{std::exchange(other.pilot, nullptr)},
+        remap{std::exchange(other.remap, nullptr)},
+        slots{std::exchange(other.slots, nullptr)},
+        mapping{std::move(other.mapping)} {}
+
+  ~PerfectHashST() {
+    delete[] own.pilot;
+    delete[] own.remap;
+    delete[] own.slots;
+  }
+
+  static int buckets(int n) {
+    return std::max(2, int(std::ceil(6.0 * n / std::log2(n + 2.0))));
+  }
+  static int denseBuckets(int B) { return std::max(1, B * 3 / 10); }
+  static int positions(int n) { return n + n / 99; }
+
+  std::uint64_t hash(const Key &key) const {
+    return mixHash(std::hash<Key>{}(key) ^ seed);
+  }
+  int bucket(std::uint64_t h) const {
+    std::uint64_t hi{h >> 32};
+    return std::uint32_t(h) < DENSE ? hi * dense >> 32
+                                    : dense + (hi * (B - dense) >> 32);
+  }
+  int position(std::uint64_t h, std::uint32_t p) const {
+    return std::uint32_t(mixHash(h ^ p)) * std::uint64_t(m) >> 32;
+  }
+
+  const Value *search(const Key &key) const {
+    if (n == 0)
+      return nullptr;
+    std::uint64_t h{hash(key)};
+    int q{position(h, pilot[bucket(h)])};
+    const Slot &s{slots[q < n ? q : remap[q - n]]};
+    return s.key == key ? &s.val : nullptr;
+  }
+  bool contains(const Key &key) const { return search(key); }
+  int size() const { return n; }
+  bool empty() const { return size() == 0; }
+
+  Built build(std::span<const Key> keys, std::span<const Value> vals) {
+    delete[] own.pilot;
+    delete[] own.remap;
+    delete[] own.slots;
+    own = {}, pilot = nullptr, remap = nullptr, slots = nullptr;
+    int count(keys.size());
+    B = buckets(count), dense = denseBuckets(B);
+
+    // 按桶计数排序, 桶内按(散列值, 下标)排, 相同的键只留最后一个
+    ns::vector<std::uint64_t> h(count);
+    ns::vector<int> at(count), first(B + 1, 0), order(count);
+    for (int i = 0; i < count; ++i)
+      ++first[(at[i] = bucket(h[i] = hash(keys[i]))) + 1];
+    for (int b = 0; b < B; ++b)
+      first[b + 1] += first[b];
+    ns::vector<int> next(first);
+    for (int i = 0; i < count; ++i)
+      order[next[at[i]]++] = i;
+    n = 0;
+    for (int b = 0; b < B; ++b) {
+      int lo{first[b]}, hi{first[b + 1]};
+      std::sort(&order[0] + lo, &order[0] + hi, [&](int x, int y) {
+        return h[x] < h[y] || (h[x] == h[y] && x < y);
+      });
+      first[b] = n;
+      for (int j = lo; j < hi; ++j) {
+        int i{order[j]};
+        if (j + 1 < hi && h[order[j + 1]] == h[i]) {
+          if (!(keys[order[j + 1]] == keys[i]))
+            return COLLISION;
+          continue;
+        }
+        order[n++] = i;
+      }
+    }
+    first[B] = n, m = positions(n);
+
+    // 大桶可选的位置多, 先放
+    ns::vector<int> bySize(B);
+    for (int b = 0; b < B; ++b)
+      bySize[b] = b;
+    std::sort(bySize.begin(), bySize.end(), [&](int x, int y) {
+      return first[x + 1] - first[x] > first[y + 1] - first[y];
+    });
+    // 占用位图; 单键桶平均要试m/空位数次, 位图小才留得住缓存
+    pilot = own.pilot = new std::uint32_t[B]{};
+    ns::vector<std::uint64_t> taken(m / 64 + 1, 0);
+    auto flip = [&](int q) { taken[q >> 6] ^= std::uint64_t(1) << (q & 63); };
+    auto test = [&](int q) { return taken[q >> 6] >> (q & 63) & 1; };
+    ns::vector<int> pos(n);
+    for (int b : bySize) {
+      int lo{first[b]}, hi{first[b + 1]};
+      if (lo == hi)
+        break;
+      for (std::uint32_t p = 0;; ++p) {
+        if (p == UINT32_MAX)
+          return RESEED;
+        int j{lo};
+        for (; j < hi && !test(pos[j] = position(h[order[j]], p)); ++j)
+          flip(pos[j]);
+        if (j == hi) {
+          own.pilot[b] = p;
+          break;
+        }
+        while (j-- > lo)
+          flip(pos[j]);
+      }
+    }
+    // [n, m)中占用的位置依次对应[0, n)中的空位, 两者个数相等
+    remap = own.remap = new int[m - n]{};
+    for (int q = n, free = 0; q < m; ++q)
+      if (test(q)) {
+        while (test(free))
+          ++free;
+        own.remap[q - n] = free++;
+      }
+    slots = own.slots = new Slot[n];
+    for (int j = 0; j < n; ++j) {
+      int q{pos[j] < n ? pos[j] : remap[pos[j] - n]};
+      own.slots[q] = {keys[order[j]], vals[order[j]]};
+    }
+    return OK;
+  }
+};
+
+struct PerfectHashHeader {
+  static constexpr char MAGIC[8]{'P', 'E', 'R', 'F', 'H', 'A', 'S', 'H'};
+  static constexpr std::uint32_t VERSION{1}, ENDIAN{0x01020304};
+  char magic[8];
+  std::uint32_t version, endian;
+  std::uint32_t keySize, slotSize;
+  std::uint64_t seed;
+  std::int64_t n, B;
+  std::uint64_t pilotAt, remapAt, slotAt;
+};
+static_assert(sizeof(PerfectHashHeader) == 72);
+
+template <class Key, class Value>
+PerfectHashHeader perfectHashHeader(std::uint64_t seed, int n, int B) {
+  using ST = PerfectHashST<Key, Value>;
+  PerfectHashHeader h{};
+  std::memcpy(h.magic, PerfectHashHeader::MAGIC, sizeof h.magic);
+  h.version = PerfectHashHeader::VERSION;
+  h.endian = PerfectHashHeader::ENDIAN;
+  h.keySize = sizeof(Key), h.slotSize = sizeof(typename ST::Slot);
+  h.seed = seed, h.n = n, h.B = B;
+  h.pilotAt = alignUp(sizeof h);
+  h.remapAt = alignUp(h.pilotAt + sizeof(std::uint32_t) * h.B);
+  h.slotAt = alignUp(h.remapAt + sizeof(int) * (ST::positions(n) - n));
+  return h;
+}
+
+// 写入失败返回false
+template <class Key, class Value>
+bool writePerfectHash(const char *path, const PerfectHashST<Key, Value> &st) {
+  PerfectHashHeader h{perfectHashHeader<Key, Value>(st.seed, st.n, st.B)};
+  return AlignedWriter(path)
+      .put(0, &h, sizeof h)
+      .put(h.pilotAt, st.pilot, sizeof(std::uint32_t) * st.B)
+      .put(h.remapAt, st.remap, sizeof(int) * (st.m - st.n))
+      .put(h.slotAt, st.slots, std::size_t(h.slotSize) * st.n)
+      .close();
+}
+
+// 文件不存在, 键值类型或版本不符, 长度不足时返回空
+template <class Key, class Value>
+std::optional<PerfectHashST<Key, Value>> loadPerfectHash(const char *path) {
+  using ST = PerfectHashST<Key, Value>;
+  auto file{MappedFile::open(path, sizeof(PerfectHashHeader))};
+  if (!file)
+    return std::nullopt;
+
+  const auto &h{*file->at<PerfectHashHeader>(0)};
+  auto remap{file->at<int>(h.remapAt)};
+  // 有重复键时B按去重前的个数取, 只要求不少于2; remap须指向[0, n)
+  bool ok{0 <= h.n && h.n < INT32_MAX / 2 && 2 <= h.B && h.B < INT32_MAX};
+  if (ok) {
+    PerfectHashHeader want{perfectHashHeader<Key, Value>(h.seed, h.n, h.B)};
+    ok = std::memcmp(&h, &want, sizeof h) == 0 &&
+         h.slotAt + h.slotSize * h.n <= file->length &&
+         std::all_of(remap, remap + ST::positions(h.n) - h.n,
+                     [&](int q) { return 0 <= q && q < h.n; });
+  }
+  if (!ok)
+    return std::nullopt;
+  file->willNeed();
+  return std::optional<ST>{std::in_place,
+                           h.seed,
+                           int(h.n),
+                           int(h.B),
+                           file->at<std::uint32_t>(h.pilotAt),
+                           remap,
+                           file->at<typename ST::Slot>(h.slotAt),
+                           std::move(*file)};
+}
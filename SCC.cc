@@ -1,5 +1,4 @@
 #include "DepthFirstOrder.hh"
-#include "Graph.hh"
 
 // 有向图都是以强连通块为顶点的有向无环图
 struct KosarajuSCC {
@@ -7,7 +6,9 @@ struct KosarajuSCC {
   ns::deque<int> id;
   int count;
 
-  KosarajuSCC(const Digraph &G) : marked(G.V, false), id(G.V), count{0} {
+  template <class T>
+    requires isGraphLike<T, Digraph>
+  KosarajuSCC(const T &G) : marked(G.V, false), id(G.V), count{0} {
     DepthFirstOrder DFS(G.reverse());
     for (int v : DFS.reversePost())
       if (!marked[v]) {
@@ -16,7 +17,7 @@ struct KosarajuSCC {
       }
   }
 
-  void dfs(const Digraph &G, int v) {
+  template <class T> void dfs(const T &G, int v) {
     marked[v] = true;
     id[v] = count;
     for (int w : G.adj[v]) {
@@ -33,13 +34,15 @@ struct TarjanSCC {
   ns::deque<int> id, low, stack;
   int clock{0}, count{0};
 
-  TarjanSCC(const Digraph &G) : marked(G.V, false), id(G.V), low(G.V) {
+  template <class T>
+    requires isGraphLike<T, Digraph>
+  TarjanSCC(const T &G) : marked(G.V, false), id(G.V), low(G.V) {
     for (int v = 0; v < G.V; v++)
       if (!marked[v])
         dfs(G, v);
   }
 
-  void dfs(const Digraph &G, int v) {
+  template <class T> void dfs(const T &G, int v) {
     marked[v] = true;
     low[v] = ++clock;
     int min = low[v];
@@ -102,5 +105,14 @@ int main() {
     for (int v = 0; v < G.V; v++)
       for (int w = v; w < G.V; w++)
         assert(tscc.connected(v, w) == kscc.connected(v, w));
+
+    CSR<Digraph> csr(DG);
+    KosarajuSCC kcsr(csr);
+    TarjanSCC tcsr(csr);
+    assert(kcsr.count == kscc.count && tcsr.count == tscc.count);
+    for (int v = 0; v < G.V; v++) {
+      assert(kcsr.id[v] == kscc.id[v]);
+      assert(tcsr.id[v] == tscc.id[v]);
+    }
   }
 }
\ No newline at end of file
@@ -1,13 +1,10 @@
 #include "Cycle.hh"
 #include "DepthFirstOrder.hh"
 #include "Graph.hh"
+#include "SPT.hh"
 
-struct AcyclicSP {
-  ns::deque<DirectedEdge *> edgeTo;
-  ns::deque<int> distTo;
-
-  AcyclicSP(const EdgeWeightedDigraph &G, int s)
-      : edgeTo(G.V, nullptr), distTo(G.V, 0xffff) {
+struct AcyclicSP : SPT {
+  AcyclicSP(const EdgeWeightedDigraph &G, int s) : SPT(G.V) {
     assert(0 <= s && s < G.V);
     assert(!EdgeWeightedDirectedCycle(G).hasCycle());
     distTo[s] = 0;
@@ -22,24 +19,8 @@ struct AcyclicSP {
 
   void relax(const DirectedEdge &e) {
     int v{e.from}, w{e.to};
-    if (distTo[w] > distTo[v] + e.weight) {
-      distTo[w] = distTo[v] + e.weight;
-      delete edgeTo[w];
-      edgeTo[w] = new DirectedEdge(e);
-    }
-  }
-
-  ~AcyclicSP() {
-    for (auto e : edgeTo)
-      delete e;
-  }
-
-  bool hasPathTo(int v) const { return distTo[v] < 0xffff; }
-  auto pathTo(int v) const {
-    ns::deque<DirectedEdge> path;
-    for (auto e{edgeTo[v]}; e; e = edgeTo[e->from])
-      path.push_front(*e);
-    return path;
+    if (distTo[w] > distTo[v] + e.weight)
+      setEdgeTo(e);
   }
 };
 
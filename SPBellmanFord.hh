@@ -1,12 +1,11 @@
 #include "Cycle.hh"
 #include "Graph.hh"
+#include "SPT.hh"
 
-struct BellmanFord {
-  ns::deque<DirectedEdge *> edgeTo;
-  ns::deque<int> distTo;
+struct BellmanFord : SPT {
   bool negativeCycle;
   BellmanFord(const EdgeWeightedDigraph &G, int s)
-      : edgeTo(G.V, nullptr), distTo(G.V, 0xffff), negativeCycle{false} {
+      : SPT(G.V), negativeCycle{false} {
     assert(0 <= s && s < G.V);
     distTo[s] = 0;
     for (int pass = 1; pass < G.V; ++pass)
@@ -15,11 +14,8 @@ struct BellmanFord {
           continue;
         for (const auto &e : G.adj[v]) {
           int w{e.to};
-          if (distTo[w] > distTo[v] + e.weight) {
-            distTo[w] = distTo[v] + e.weight;
-            delete edgeTo[w];
-            edgeTo[w] = new DirectedEdge(e);
-          }
+          if (distTo[w] > distTo[v] + e.weight)
+            setEdgeTo(e);
         }
       }
     // check negative cycle
@@ -36,33 +32,19 @@ struct BellmanFord {
     }
   }
 
-  ~BellmanFord() {
-    for (auto e : edgeTo)
-      delete e;
-  }
-
   bool hasNegativeCycle() const { return negativeCycle; }
   bool hasPathTo(int v) const {
     return !hasNegativeCycle() && distTo[v] < 0xffff;
   }
-  auto pathTo(int v) const {
-    ns::deque<DirectedEdge> path;
-    for (auto e{edgeTo[v]}; e; e = edgeTo[e->from])
-      path.push_front(*e);
-    return path;
-  }
 };
 
-struct QueueBasedBF {
-  ns::deque<int> distTo;
-  ns::deque<DirectedEdge *> edgeTo;
+struct QueueBasedBF : SPT {
   ns::deque<bool> onQueue;
   ns::deque<int> queue;
   ns::deque<DirectedEdge> cycle;
   int cost;
   QueueBasedBF(const EdgeWeightedDigraph &G, int s)
-      : distTo(G.V, 0xffff), edgeTo(G.V, nullptr), onQueue(G.V, false),
-        cost{0} {
+      : SPT(G.V), onQueue(G.V, false), cost{0} {
     assert(0 <= s && s < G.V);
     distTo[s] = 0;
     queue.push_back(s), onQueue[s] = true;
@@ -77,9 +59,7 @@ struct QueueBasedBF {
     for (const auto &e : G.adj[v]) {
       int w{e.to};
       if (distTo[w] > distTo[v] + e.weight) {
-        distTo[w] = distTo[v] + e.weight;
-        delete edgeTo[w];
-        edgeTo[w] = new DirectedEdge(e);
+        setEdgeTo(e);
         if (!onQueue[w]) {
           queue.push_back(w);
           onQueue[w] = true;
@@ -94,17 +74,12 @@ struct QueueBasedBF {
     }
   }
 
-  ~QueueBasedBF() {
-    for (auto e : edgeTo)
-      delete e;
-  }
-
   void findNegativeCycle() {
     int V{edgeTo.size()};
     EdgeWeightedDigraph spt(V);
     for (int v = 0; v < V; ++v) {
-      if (edgeTo[v])
-        spt.addEdge(*edgeTo[v]);
+      if (hasEdgeTo(v))
+        spt.addEdge(treeEdge(v));
     }
     EdgeWeightedDirectedCycle finder(spt);
     if (finder.hasCycle())
@@ -116,10 +91,4 @@ struct QueueBasedBF {
   bool hasPathTo(int v) const {
     return !hasNegativeCycle() && distTo[v] < 0xffff;
   }
-  auto pathTo(int v) const {
-    ns::deque<DirectedEdge> path;
-    for (auto e{edgeTo[v]}; e; e = edgeTo[e->from])
-      path.push_front(*e);
-    return path;
-  }
-};
\ No newline at end of file
+};
@@ -1,12 +1,16 @@
-#include "Graph.hh"
+#include "CSR.hh"
 #include "PQ.hh"
+#include "SPT.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 
-struct DikstraSP {
-  ns::deque<int> distTo;
-  ns::deque<DirectedEdge *> edgeTo;
-  IndexMinPQ<int> pq;
-  DikstraSP(const EdgeWeightedDigraph &G, int s)
-      : distTo(G.V, 0xffff), edgeTo(G.V, nullptr), pq(G.V) {
+template <class IndexPQ = IndexMinPQ<int>> struct DikstraSP : SPT {
+  IndexPQ pq;
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedDigraph>
+  DikstraSP(const T &G, int s) : SPT(G.V), pq(G.V) {
     assert(0 <= s && s < G.V);
     distTo[s] = 0;
     pq.insert(s, distTo[s]);
@@ -20,41 +24,26 @@ struct DikstraSP {
   void relax(const DirectedEdge &e) {
     int v{e.from}, w{e.to};
     if (distTo[w] > distTo[v] + e.weight) {
-      distTo[w] = distTo[v] + e.weight;
-      delete edgeTo[w];
-      edgeTo[w] = new DirectedEdge(e);
+      setEdgeTo(e);
       if (pq.contains(w))
         pq.decreaseKey(w, distTo[w]);
       else
         pq.insert(w, distTo[w]);
     }
   }
-  ~DikstraSP() {
-    for (auto e : edgeTo)
-      delete e;
-  }
-
-  bool hasPathTo(int v) const { return distTo[v] < 0xffff; }
-  auto pathTo(int v) const {
-    ns::deque<DirectedEdge> path;
-    for (auto e{edgeTo[v]}; e; e = edgeTo[e->from])
-      path.push_front(*e);
-    return path;
-  }
 };
 
 // priority first search shortest path tree
-struct LazyDikstra {
+struct LazyDikstra : SPT {
   struct Vertex {
     int v, distTo;
     bool operator>(const Vertex &rhs) const { return distTo > rhs.distTo; }
   };
   ns::deque<bool> marked;
-  ns::deque<int> distTo;
-  ns::deque<DirectedEdge *> edgeTo;
   PQ<Vertex, Bigger<Vertex>> pq;
-  LazyDikstra(const EdgeWeightedDigraph &G, int s)
-      : marked(G.V, false), distTo(G.V, 0xffff), edgeTo(G.V, nullptr), pq(G.V) {
+  template <class T>
+    requires isGraphLike<T, EdgeWeightedDigraph>
+  LazyDikstra(const T &G, int s) : SPT(G.V), marked(G.V, false), pq(G.V) {
     assert(0 <= s && s < G.V);
     distTo[s] = 0;
     pq.push({s, 0});
@@ -66,28 +55,125 @@ struct LazyDikstra {
     }
   }
 
-  void relax(const EdgeWeightedDigraph &G, int v) {
+  template <class T> void relax(const T &G, int v) {
     marked[v] = true;
     for (const auto &e : G.adj[v]) {
       int w{e.to};
       if (distTo[w] > distTo[v] + e.weight) {
-        distTo[w] = distTo[v] + e.weight;
-        delete edgeTo[w];
-        edgeTo[w] = new DirectedEdge(e);
+        setEdgeTo(e);
         pq.push({w, distTo[w]});
       }
     }
   }
-  ~LazyDikstra() {
-    for (auto e : edgeTo)
-      delete e;
+};
+
+// delta步进: 按distTo/delta分桶, 桶内反复松弛轻边(weight<=delta)直至桶空,
+// 再一次性松弛该桶所有顶点的重边, 各阶段内顶点并行松弛
+struct DeltaSteppingSP : SPT {
+  // 每线程的桶, 填充避免伪共享
+  struct Local {
+    ns::vector<ns::vector<int>> bins;
+    ns::vector<int> settled;
+    char pad[64];
+  };
+  DeltaSteppingSP(const EdgeWeightedDigraph &G, int s, int delta = 0,
+                  ThreadPool &pool = ThreadPool::global())
+      : DeltaSteppingSP(CSR<EdgeWeightedDigraph>(G), s, delta, pool) {}
+
+  DeltaSteppingSP(const CSR<EdgeWeightedDigraph> &G, int s, int delta = 0,
+                  ThreadPool &pool = ThreadPool::global())
+      : SPT(G.V) {
+    assert(0 <= s && s < G.V);
+    assert(std::all_of(G.weight, G.weight + G.E, [](int w) { return w >= 0; }));
+    if (delta <= 0 && G.E > 0)
+      delta = *std::max_element(G.weight, G.weight + G.E) / 2;
+    delta = std::max(delta, 1);
+    // 高32位距离, 低32位前驱, 整体原子更新
+    ns::vector<std::uint64_t> state(G.V, pack(0xffff, -1));
+    ns::vector<int> settled(G.V, -1), frontier, R;
+    ns::vector<Local> local(pool.size());
+    state[s] = pack(0, -1);
+    push(local[0].bins, 0, s);
+    for (int i = 0; i != -1; i = next(local, i)) {
+      while (gather(local, i, frontier)) {
+        pool.parallelFor(frontier.size(), 64, [&](long lo, long hi, int tid) {
+          for (long k = lo; k < hi; ++k) {
+            int u{frontier[k]};
+            if (std::atomic_ref<int>(settled[u]).exchange(i) != i)
+              local[tid].settled.push_back(u);
+            relax(G, state, u, delta, true, local[tid].bins);
+          }
+        });
+      }
+      R = ns::vector<int>();
+      for (auto &l : local) {
+        for (int u : l.settled)
+          R.push_back(u);
+        l.settled = ns::vector<int>();
+      }
+      pool.parallelFor(R.size(), 64, [&](long lo, long hi, int tid) {
+        for (long k = lo; k < hi; ++k)
+          relax(G, state, R[k], delta, false, local[tid].bins);
+      });
+    }
+    for (int v = 0; v < G.V; ++v)
+      distTo[v] = state[v] >> 32, edgeTo[v] = int(state[v] & 0xffffffff);
+    for (int v = 0; v < G.V; ++v)
+      if (hasEdgeTo(v))
+        weightTo[v] = distTo[v] - distTo[edgeTo[v]];
+  }
+
+  static std::uint64_t pack(int dist, int from) {
+    return std::uint64_t(dist) << 32 | std::uint32_t(from);
+  }
+
+  static void push(ns::vector<ns::vector<int>> &bins, int b, int v) {
+    while (bins.size() <= b)
+      bins.push_back();
+    bins[b].push_back(v);
+  }
+
+  static void relax(const CSR<EdgeWeightedDigraph> &G,
+                    ns::vector<std::uint64_t> &state, int u, int delta,
+                    bool light, ns::vector<ns::vector<int>> &bins) {
+    int du(std::atomic_ref<std::uint64_t>(state[u]).load(
+               std::memory_order_relaxed) >>
+           32);
+    for (int k = G.offset[u]; k < G.offset[u + 1]; ++k) {
+      if ((G.weight[k] <= delta) != light)
+        continue;
+      int w{G.target[k]}, dist{du + G.weight[k]};
+      std::atomic_ref<std::uint64_t> ref(state[w]);
+      for (auto cur{ref.load(std::memory_order_relaxed)}; (cur >> 32) > dist;)
+        if (ref.compare_exchange_weak(cur, pack(dist, u),
+                                      std::memory_order_relaxed)) {
+          push(bins, dist / delta, w);
+          break;
+        }
+    }
+  }
+
+  // 取出各线程第i个桶作为本轮前沿
+  static bool gather(ns::vector<Local> &local, int i,
+                     ns::vector<int> &frontier) {
+    frontier = ns::vector<int>();
+    for (auto &l : local)
+      if (i < l.bins.size()) {
+        for (int v : l.bins[i])
+          frontier.push_back(v);
+        l.bins[i] = ns::vector<int>();
+      }
+    return !frontier.empty();
   }
 
-  bool hasPathTo(int v) const { return distTo[v] < 0xffff; }
-  auto pathTo(int v) const {
-    ns::deque<DirectedEdge> path;
-    for (auto e{edgeTo[v]}; e; e = edgeTo[e->from])
-      path.push_front(*e);
-    return path;
+  static int next(const ns::vector<Local> &local, int i) {
+    int b{-1};
+    for (const auto &l : local)
+      for (int j = i + 1; j < l.bins.size() && (b == -1 || j < b); ++j)
+        if (!l.bins[j].empty()) {
+          b = j;
+          break;
+        }
+    return b;
   }
 };
@@ -1,36 +1,117 @@
-#include "deque.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <new>
+#include <span>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// 行主序连续矩阵, 行宽补齐到分块大小, 首地址按缓存行对齐
+struct Matrix {
+  static constexpr int B{64};
+  int V, stride;
+  int *a;
+  Matrix(int V, int fill)
+      : V{V}, stride{(V + B - 1) / B * B},
+        a{new (std::align_val_t{64}) int[long(stride) * stride]} {
+    std::fill(a, a + long(stride) * stride, fill);
+  }
+  Matrix(const Matrix &) = delete;
+  Matrix &operator=(const Matrix &) = delete;
+  ~Matrix() { ::operator delete[](a, std::align_val_t{64}); }
+
+  int *row(int i) const { return a + long(i) * stride; }
+  std::span<int> operator[](int i) const { return {row(i), std::size_t(V)}; }
+};
 
 struct AdjMatrixEdgeWeightedDigraph {
   int V;
-  ns::deque<ns::deque<int>> adj;
-  AdjMatrixEdgeWeightedDigraph(int v)
-      : V{v}, adj(v, ns::deque<int>(v, 0xffff)) {}
+  Matrix adj;
+  AdjMatrixEdgeWeightedDigraph(int v) : V{v}, adj(v, 0xffff) {}
 };
 
+/**
+ * 分块Floyd, 第kb轮
+ *   1 主对角块(kb,kb)内做Floyd
+ *   2 同行块(kb,j)与同列块(i,kb)只依赖主对角块, 并行
+ *   3 其余块(i,j)由(i,kb)和(kb,j)做min-plus乘法, 并行
+ */
 struct Floyd {
+  static constexpr int B{Matrix::B};
+  // 两个INF相加不溢出, 不小于INF/2视为不可达
+  static constexpr int INF{1 << 29};
   bool negativeCycle;
-  ns::deque<ns::deque<int>> distTo;
-  Floyd(const AdjMatrixEdgeWeightedDigraph &G)
-      : negativeCycle{false}, distTo{G.adj} {
-    int V = G.V;
+  Matrix distTo;
+  Floyd(const AdjMatrixEdgeWeightedDigraph &G,
+        ThreadPool &pool = ThreadPool::global())
+      : negativeCycle{false}, distTo(G.V, INF) {
+    int V{G.V}, n{distTo.stride}, nb{n / B};
     for (int v = 0; v < V; ++v)
-      distTo[v][v] = 0;
-
-    for (int i = 0; i < V; ++i) {
-      for (int v = 0; v < V; ++v) {
-        if (distTo[v][i] == 0xffff)
-          continue;
-        for (int w = 0; w < V; ++w) {
-          if (distTo[i][w] == 0xffff)
-            continue;
-          if (distTo[v][w] > distTo[v][i] + distTo[i][w])
-            distTo[v][w] = distTo[v][i] + distTo[i][w];
-        }
+      for (int w = 0; w < V; ++w)
+        if (G.adj[v][w] != 0xffff)
+          distTo[v][w] = G.adj[v][w];
+    for (int v = 0; v < n; ++v)
+      distTo.row(v)[v] = 0;
+
+    for (int kb = 0; kb < nb; ++kb) {
+      block(kb, kb, kb);
+      pool.parallelFor(2 * nb, 1, [&](long lo, long hi, int) {
+        for (long t = lo; t < hi; ++t)
+          if (int b = t % nb; b != kb)
+            t < nb ? block(kb, b, kb) : block(b, kb, kb);
+      });
+      pool.parallelFor(long(nb) * nb, 1, [&](long lo, long hi, int) {
+        for (long t = lo; t < hi; ++t)
+          if (int ib = t / nb, jb = t % nb; ib != kb && jb != kb)
+            multiply(ib, jb, kb);
+      });
+      for (int v = 0; v < V; ++v)
         if (distTo[v][v] < 0) {
           negativeCycle = true;
           return;
         }
-      }
     }
+    for (int v = 0; v < V; ++v)
+      for (int &d : distTo[v])
+        if (d >= INF / 2)
+          d = 0xffff;
+  }
+
+  int *at(int ib, int jb) const { return distTo.row(ib * B) + jb * B; }
+
+  // 与主对角块有重叠, 逐个中转点k更新
+  void block(int ib, int jb, int kb) {
+    int n{distTo.stride};
+    int *D{at(ib, jb)}, *C{at(ib, kb)}, *R{at(kb, jb)};
+    for (int k = 0; k < B; ++k)
+      for (int i = 0; i < B; ++i)
+        if (int a{C[long(i) * n + k]}; a < INF / 2)
+          minPlus(D + long(i) * n, a, R + long(k) * n);
+  }
+
+  // 互不重叠, D的一行在缓存中累积B个中转点
+  void multiply(int ib, int jb, int kb) {
+    int n{distTo.stride};
+    int *D{at(ib, jb)}, *C{at(ib, kb)}, *R{at(kb, jb)};
+    for (int i = 0; i < B; ++i)
+      for (int k = 0; k < B; ++k)
+        if (int a{C[long(i) * n + k]}; a < INF / 2)
+          minPlus(D + long(i) * n, a, R + long(k) * n);
+  }
+
+  // d[j] = min(d[j], a + r[j]), 下界-INF防止负环使距离溢出
+  static void minPlus(int *d, int a, const int *r) {
+#if defined(__AVX2__)
+    __m256i va{_mm256_set1_epi32(a)}, floor{_mm256_set1_epi32(-INF)};
+    for (int j = 0; j < B; j += 8) {
+      __m256i x{_mm256_load_si256((const __m256i *)(r + j))};
+      __m256i y{_mm256_load_si256((const __m256i *)(d + j))};
+      x = _mm256_max_epi32(_mm256_add_epi32(va, x), floor);
+      _mm256_store_si256((__m256i *)(d + j), _mm256_min_epi32(x, y));
+    }
+#else
+    for (int j = 0; j < B; ++j)
+      d[j] = std::min(d[j], std::max(a + r[j], -INF));
+#endif
   }
 };
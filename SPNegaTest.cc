@@ -108,5 +108,28 @@ int main() {
     } else {
       std::print("Has Negative Cycle\n");
     }
+    assert(!BFSP.hasNegativeCycle() || FW.negativeCycle);
+  }
+
+  // 跨多个分块, 与逐源BellmanFord比较
+  ThreadPool pool(4);
+  for (int k = 0; k < 4; k++) {
+    constexpr int v{150}, e{600};
+    EdgeWeightedDigraph EWD(v);
+    AdjMatrixEdgeWeightedDigraph AMEWD(v);
+    generateGraph(EWD, e);
+    for (const auto &e : EWD.edges())
+      AMEWD.adj[e.from][e.to] = e.weight;
+    Floyd FW(AMEWD, pool);
+    assert(!FW.negativeCycle);
+    for (int s = 0; s < v; s++) {
+      BellmanFord BFSP(EWD, s);
+      assert(std::equal(BFSP.distTo.begin(), BFSP.distTo.end(),
+                        FW.distTo[s].begin(), FW.distTo[s].end()));
+    }
+    // 加一条负边构成负环
+    DirectedEdge f{EWD.edges()[0]};
+    AMEWD.adj[f.to][f.from] = -f.weight - 1;
+    assert(Floyd(AMEWD, pool).negativeCycle);
   }
 }
\ No newline at end of file
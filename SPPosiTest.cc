@@ -56,6 +56,36 @@ int main() {
     assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(), LDSP.distTo.begin(),
                       LDSP.distTo.end()));
 
+    CSR<EdgeWeightedDigraph> csr(EWD);
+    DikstraSP CDSP(csr, source);
+    LazyDikstra CLDSP(csr, source);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      CDSP.distTo.begin(), CDSP.distTo.end()));
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      CLDSP.distTo.begin(), CLDSP.distTo.end()));
+
+    DikstraSP<DaryIndexMinPQ<int, 4>> D4SP(EWD, source);
+    DikstraSP<DaryIndexMinPQ<int, 8>> D8SP(csr, source);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      D4SP.distTo.begin(), D4SP.distTo.end()));
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      D8SP.distTo.begin(), D8SP.distTo.end()));
+
+    // generateGraph的权重在[0,7]
+    DikstraSP<RadixIndexMinPQ<int>> RSP(csr, source);
+    DikstraSP<DialIndexMinPQ<7>> BSP(EWD, source);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      RSP.distTo.begin(), RSP.distTo.end()));
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      BSP.distTo.begin(), BSP.distTo.end()));
+
+    DeltaSteppingSP DSSP(csr, source);
+    std::print("DeltaStepping\n");
+    printSP(DSSP, v);
+    std::print("\n");
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      DSSP.distTo.begin(), DSSP.distTo.end()));
+
     if (!EDC.hasCycle()) {
       AcyclicSP ASP(EWD, source);
       std::print("AcyclicSP\n");
@@ -71,4 +101,28 @@ int main() {
                         ASP.distTo.begin(), ASP.distTo.end()));
     }
   }
+
+  ThreadPool pool(4);
+  for (int k = 0; k < 8; k++) {
+    EdgeWeightedDigraph EWD(1024);
+    generateGraph(EWD, 4096);
+    DikstraSP DSP(EWD, k);
+    DikstraSP<RadixIndexMinPQ<int>> RSP(EWD, k);
+    DikstraSP<DialIndexMinPQ<7>> BSP(EWD, k);
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      RSP.distTo.begin(), RSP.distTo.end()));
+    assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                      BSP.distTo.begin(), BSP.distTo.end()));
+    for (int delta : {1, 2, 8}) {
+      DeltaSteppingSP DSSP(EWD, k, delta, pool);
+      assert(std::equal(DSP.distTo.begin(), DSP.distTo.end(),
+                        DSSP.distTo.begin(), DSSP.distTo.end()));
+      for (int w = 0; w < EWD.V; w++) {
+        int dist{0};
+        for (const auto &e : DSSP.pathTo(w))
+          dist += e.weight;
+        assert(!DSSP.hasPathTo(w) || dist == DSSP.distTo[w]);
+      }
+    }
+  }
 }
@@ -0,0 +1,28 @@
+#pragma once
+#include "Graph.hh"
+#include "vector.hh"
+
+// 最短路径树
+// edgeTo[w]是树边的起点, weightTo[w]是树边的权重, 松弛时不再分配DirectedEdge
+struct SPT {
+  ns::vector<int> distTo, edgeTo, weightTo;
+
+  SPT(int V) : distTo(V, 0xffff), edgeTo(V, -1), weightTo(V, 0) {}
+
+  void setEdgeTo(const DirectedEdge &e) {
+    int v{e.from}, w{e.to};
+    distTo[w] = distTo[v] + e.weight;
+    edgeTo[w] = v, weightTo[w] = e.weight;
+  }
+
+  bool hasEdgeTo(int v) const { return edgeTo[v] != -1; }
+  DirectedEdge treeEdge(int v) const { return {edgeTo[v], v, weightTo[v]}; }
+
+  bool hasPathTo(int v) const { return distTo[v] < 0xffff; }
+  auto pathTo(int v) const {
+    ns::deque<DirectedEdge> path;
+    for (int w = v; hasEdgeTo(w); w = edgeTo[w])
+      path.push_front(treeEdge(w));
+    return path;
+  }
+};
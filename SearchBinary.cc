@@ -1,10 +1,13 @@
+#include "PQ.hh"
 #include "vector.hh"
 #include <algorithm>
+#include <bit>
 #include <cassert>
 #include <concepts>
 #include <cstdlib>
 #include <ctime>
 #include <print>
+#include <utility>
 
 // 折半查找
 template <typename T>
@@ -91,6 +94,128 @@ int leftBisection(const T &key, const ns::vector<T> &A) {
   return lo;
 }
 
+/**
+ * 静态有序集合, 键按Eytzinger(层序)排列
+ *   b[1]是根, b[k]的孩子是b[2k], b[2k+1], 最后一层从左往右填
+ *   查找时k = 2k + (b[k] < key), 不分支; 一条缓存行装L个键, b按64字节
+ *   对齐, b[kL]起的L个恰在同一行, 是k往下log L层的全部后代, 提前预取,
+ *   访存与比较重叠
+ *   下降结束后去掉k末尾的1和一个0, 就是最后一次往左拐的结点
+ * 有序性只在构造时检查一次; 查询返回原有序数组中的下标
+ * Skew让b偏离行首Skew个元素, 只给基准测试对比对齐的效果
+ */
+template <typename T, int Skew = 0>
+  requires std::totally_ordered<T>
+struct Eytzinger {
+  static constexpr int L{std::max(1, int(64 / sizeof(T)))};
+  int n, height;
+  T *buf, *b;
+
+  Eytzinger(const ns::vector<T> &A)
+      : n{A.size()}, height{int(std::bit_width(unsigned(A.size())))},
+        buf{alignedNew<T>(A.size() + 1 + Skew)}, b{buf + Skew} {
+    assert(std::ranges::is_sorted(A));
+    int i{0};
+    build(A, i, 1);
+  }
+  Eytzinger(const Eytzinger &) = delete;
+  Eytzinger &operator=(const Eytzinger &) = delete;
+  Eytzinger(Eytzinger &&other)
+      : n{other.n}, height{other.height},
+        buf{std::exchange(other.buf, nullptr)}, b{other.b} {}
+  ~Eytzinger() {
+    if (buf)
+      alignedFree(buf, n + 1 + Skew);
+  }
+
+  // 中序遍历依次填入
+  void build(const ns::vector<T> &A, int &i, int k) {
+    if (k > n)
+      return;
+    build(A, i, 2 * k);
+    b[k] = A[i++];
+    build(A, i, 2 * k + 1);
+  }
+
+  // upper为假时找第一个不小于key的结点, 为真时找第一个大于key的, 没有为0
+  template <bool upper> int slot(const T &key) const {
+    const T *p{b};
+    int k{1};
+    while (k <= n) {
+      __builtin_prefetch(p + k * L);
+      if constexpr (upper)
+        k = 2 * k + !(key < p[k]);
+      else
+        k = 2 * k + (p[k] < key);
+    }
+    return k >> (std::countr_one(unsigned(k)) + 1);
+  }
+
+  /**
+   * 结点k的中序序号, 先当作最后一层是满的算, 再减去它左边缺的叶子
+   *   满树中叶子的中序序号是偶数, 序号r之前有(r + 1) / 2个叶子位
+   */
+  int rank(int k) const {
+    if (k == 0)
+      return n;
+    int d{int(std::bit_width(unsigned(k))) - 1};
+    int full{(2 * (k - (1 << d)) + 1) * (1 << (height - 1 - d)) - 1};
+    int leaves{n - (1 << (height - 1)) + 1};
+    return full - std::max(0, (full + 1) / 2 - leaves);
+  }
+
+  int lower_bound(const T &key) const { return rank(slot<false>(key)); }
+  int upper_bound(const T &key) const { return rank(slot<true>(key)); }
+  // 找不到返回-1
+  int find(const T &key) const {
+    int k{slot<false>(key)};
+    return k && !(key < b[k]) ? rank(k) : -1;
+  }
+};
+
+#ifdef BENCH
+#include "Bench.hh"
+
+template <class Index> struct State {
+  Index index;
+  ns::vector<int> A, queries;
+};
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.search("bisectionSearch", bisectionSearch<int>);
+  bench.search("fibonacciSearch", fibonacciSearch<int>);
+  bench.search("leftBisection", leftBisection<int>);
+  bench.search("rightBisection", rightBisection<int>);
+
+  // 索引在setup中建好, 不计时
+  auto search = [&]<class Index = Eytzinger<int>>(std::string_view name,
+                                                  auto f) {
+    bench.each(
+        "search", name,
+        [&](int n, Dist d) {
+          ns::vector<int> A{benchData(d, n, bench.seed)}, queries(n);
+          std::sort(A.begin(), A.end());
+          std::mt19937_64 mt(bench.seed);
+          for (int &q : queries)
+            q = mt() % 2 ? A[mt() % n] : int(mt() >> 33);
+          return State<Index>{Index(A), A, queries};
+        },
+        [&](State<Index> &s, int i) { keep(f(s, s.queries[i])); });
+  };
+  search("Eytzinger::find",
+         [](auto &s, int key) { return s.index.find(key); });
+  search("Eytzinger::lower_bound",
+         [](auto &s, int key) { return s.index.lower_bound(key); });
+  // 偏离行首8字节, 预取的后代跨两行
+  search.operator()<Eytzinger<int, 2>>(
+      "Eytzinger<skew>::lower_bound",
+      [](auto &s, int key) { return s.index.lower_bound(key); });
+  search("std::lower_bound", [](auto &s, int key) {
+    return std::lower_bound(s.A.begin(), s.A.end(), key) - s.A.begin();
+  });
+}
+#else
 int main() {
   std::srand(std::time(nullptr));
   ns::vector<int> vec{1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29};
@@ -137,4 +262,21 @@ int main() {
   std::print("\n");
 
   assert(t == u || t == u + 1);
-}
\ No newline at end of file
+
+  // 各种n下与std::lower_bound/upper_bound比对, 含重复键与越界的键
+  for (int n = 0; n < 600; ++n) {
+    ns::vector<int> A(n);
+    for (int i = 0; i < n; ++i)
+      A[i] = std::rand() % (n + 1) * 2;
+    std::sort(A.begin(), A.end());
+    Eytzinger<int> index(A);
+    for (int key = -1; key <= 2 * n + 2; ++key) {
+      auto lo{std::lower_bound(A.begin(), A.end(), key) - A.begin()};
+      auto hi{std::upper_bound(A.begin(), A.end(), key) - A.begin()};
+      assert(index.lower_bound(key) == lo && index.upper_bound(key) == hi);
+      int f{index.find(key)};
+      assert(lo == hi ? f == -1 : f == lo);
+    }
+  }
+}
+#endif
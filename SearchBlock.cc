@@ -41,6 +41,15 @@ int blockSearch(const compar &key, const ns::vector<compar> &A) {
   return -1;
 }
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.search("linearSearch", linearSearch<int>, 1 << 16);
+  bench.search("blockSearch", blockSearch<int>);
+}
+#else
 int main() {
   std::srand(std::time(nullptr));
   ns::vector<int> vec{1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29};
@@ -77,4 +86,5 @@ int main() {
   assert(blockSearch<int>(vec.back() + 1, vec) == -1);
 
   assert(r == s);
-}
\ No newline at end of file
+}
+#endif
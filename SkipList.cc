@@ -102,6 +102,14 @@ template <class K, class V> struct SkipList {
   }
 };
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.map("SkipList", [] { return std::make_unique<SkipList<int, int>>(20); });
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -122,3 +130,4 @@ int main() {
     std::print("\n");
   }
 }
+#endif
@@ -0,0 +1,456 @@
+#include "SortMerge.hh"
+#include "SortSIMD.hh"
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <print>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/**
+ * 后台I/O线程, 读写请求按提交顺序逐个执行
+ *   提交时给出结果槽, 完成后槽里是传输的字节数, 出错为-1
+ *   同一块缓冲区先写后读时, 顺序执行保证读不会覆盖还没写出的数据
+ */
+struct AsyncIO {
+  static constexpr long PENDING{-2};
+  struct Request {
+    int fd;
+    bool write;
+    char *buf;
+    long bytes, offset;
+    long *result;
+  };
+  std::mutex mtx;
+  std::condition_variable work, finished;
+  ns::deque<Request> queue;
+  bool stop{false};
+  std::thread worker{[this] { loop(); }};
+
+  ~AsyncIO() {
+    {
+      std::lock_guard lock(mtx);
+      stop = true;
+    }
+    work.notify_one();
+    worker.join();
+  }
+
+  void submit(Request r) {
+    {
+      std::lock_guard lock(mtx);
+      *r.result = PENDING;
+      queue.push_back(r);
+    }
+    work.notify_one();
+  }
+
+  long wait(long &result) {
+    std::unique_lock lock(mtx);
+    finished.wait(lock, [&] { return result != PENDING; });
+    return result;
+  }
+
+  // pread/pwrite可能只完成一部分, 读到文件尾时提前返回
+  static long transfer(const Request &r) {
+    long done{0};
+    while (done < r.bytes) {
+      long k{r.write ? ::pwrite(r.fd, r.buf + done, r.bytes - done,
+                                r.offset + done)
+                     : ::pread(r.fd, r.buf + done, r.bytes - done,
+                               r.offset + done)};
+      if (k < 0)
+        return -1;
+      if (k == 0)
+        break;
+      done += k;
+    }
+    return done;
+  }
+
+  void loop() {
+    while (true) {
+      std::unique_lock lock(mtx);
+      work.wait(lock, [&] { return stop || !queue.empty(); });
+      if (queue.empty())
+        return;
+      Request r{queue.front()};
+      queue.pop_front();
+      lock.unlock();
+      long k{transfer(r)};
+      lock.lock();
+      *r.result = k;
+      finished.notify_all();
+    }
+  }
+};
+
+// 每秒至多一行: 阶段, 完成比例, 吞吐量
+struct Progress {
+  using Clock = std::chrono::steady_clock;
+  std::FILE *out;
+  const char *phase;
+  long total, done{0};
+  Clock::time_point start{Clock::now()}, last{start};
+
+  void advance(long bytes) {
+    if (!out || bytes == 0)
+      return;
+    done += bytes;
+    auto now{Clock::now()};
+    if (now - last > std::chrono::seconds(1) || done == total) {
+      double s{std::chrono::duration<double>(now - start).count()};
+      std::print(out, "{}: {:.1f}% {:.1f} MB/s\n", phase,
+                 total ? 100.0 * done / total : 100.0,
+                 s > 0 ? done / s / (1 << 20) : 0.0);
+      last = now;
+    }
+  }
+};
+
+/**
+ * 外部排序, 把二进制文件中的T数组排好写到另一个文件, 文件可远大于内存
+ *   生成段: 按内存预算的一半分块, 读下一块的同时排序当前块(SimdSort,
+ *           不支持SIMD的类型退回IntroSort), 排好的段写入临时文件
+ *   归并: 每段两块输入缓冲, 一块归并一块预读, 输出也是两块交替写出
+ *         段数超过内存容纳的路数时多趟归并, 每趟用败者树k路归并
+ * 临时文件创建后立即unlink, 异常退出也不会残留; 出错返回false
+ */
+template <class T>
+  requires std::totally_ordered<T> && std::is_trivially_copyable_v<T>
+struct ExternalSort {
+  long memory{256L << 20};
+  std::string tmpdir{std::filesystem::temp_directory_path()};
+  std::FILE *report{stderr};
+  ThreadPool *pool{&ThreadPool::global()};
+  int runs{0}, passes{0};
+
+  struct Run {
+    long at, n;
+  };
+  AsyncIO io;
+
+  bool sort(const char *in, const char *out) {
+    runs = passes = 0;
+    int src{::open(in, O_RDONLY)};
+    if (src < 0)
+      return false;
+    int dst{::open(out, O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+    auto start{std::chrono::steady_clock::now()};
+    long size{0};
+    bool ok{dst >= 0 && sort(src, dst, size)};
+    ::close(src);
+    ok = (dst < 0 || ::close(dst) == 0) && ok;
+    if (ok && report) {
+      std::chrono::duration<double> s{std::chrono::steady_clock::now() - start};
+      std::print(report, "sorted {} bytes in {:.2f} s, {:.1f} MB/s: "
+                 "{} runs, {} passes\n",
+                 size, s.count(), size / s.count() / (1 << 20), runs, passes);
+    }
+    return ok;
+  }
+
+  // size返回文件字节数
+  bool sort(int src, int dst, long &size) {
+    struct stat st;
+    if (::fstat(src, &st) != 0 || st.st_size % sizeof(T))
+      return false;
+    long n{long(st.st_size / sizeof(T))};
+    size = st.st_size;
+    ::posix_fadvise(src, 0, 0, POSIX_FADV_SEQUENTIAL);
+    // 放得下就直接在内存中排
+    if (n * long(sizeof(T)) <= memory) {
+      ns::vector<T> A(static_cast<int>(n));
+      long got{0};
+      io.submit({src, false, bytes(A), n * long(sizeof(T)), 0, &got});
+      if (io.wait(got) != n * long(sizeof(T)))
+        return false;
+      SimdSort<T>::sort(A, *pool);
+      long wrote{0};
+      io.submit({dst, true, bytes(A), got, 0, &wrote});
+      runs = n > 0;
+      return io.wait(wrote) == got;
+    }
+
+    int tmp{temporary()};
+    if (tmp < 0)
+      return false;
+    ns::vector<Run> all;
+    bool ok{generate(src, tmp, n, all)};
+    // 每趟归并前后段在文件中的位置不变
+    for (; ok && all.size() > fanIn(); ++passes) {
+      int next{temporary()};
+      ns::vector<Run> merged;
+      Progress progress{report, "merge", n * long(sizeof(T))};
+      for (int i = 0; ok && i < all.size(); i += fanIn()) {
+        int j{std::min(all.size(), i + fanIn())};
+        long at{all[i].at}, m{all[j - 1].at + all[j - 1].n - at};
+        ok = next >= 0 && merge(tmp, all, i, j, next, at, progress);
+        merged.push_back(Run{at, m});
+      }
+      ::close(tmp);
+      tmp = next, all = merged;
+    }
+    Progress progress{report, "merge", n * long(sizeof(T))};
+    ok = ok && merge(tmp, all, 0, all.size(), dst, 0, progress);
+    ++passes;
+    ::close(tmp);
+    return ok;
+  }
+
+  static char *bytes(ns::vector<T> &A) {
+    return reinterpret_cast<char *>(A.begin());
+  }
+
+  int temporary() {
+    std::string path{tmpdir + "/SortExternal.XXXXXX"};
+    int fd{::mkstemp(path.data())};
+    if (fd >= 0)
+      ::unlink(path.c_str());
+    return fd;
+  }
+
+  // 每块至少这么大, 否则磁盘读写退化成随机访问
+  long block() const {
+    return std::max(long(sizeof(T)), std::min(256L << 10, memory / 8));
+  }
+  // 每段两块输入, 加两块输出
+  int fanIn() const { return std::max(2L, memory / (2 * block()) - 1); }
+
+  // 生成初始有序段, 两块缓冲轮流读入与排序
+  bool generate(int src, int tmp, long n, ns::vector<Run> &all) {
+    long chunk{std::clamp(memory / 2 / long(sizeof(T)), 1L, long(INT32_MAX))};
+    ns::vector<T> buf[2]{ns::vector<T>(int(chunk)), ns::vector<T>(int(chunk))};
+    long got[2]{}, wrote[2]{};
+    Progress progress{report, "runs", n * long(sizeof(T))};
+    auto read = [&](int b, long at) {
+      long m{std::min(chunk, n - at)};
+      io.submit({src, false, bytes(buf[b]), m * long(sizeof(T)),
+                 at * long(sizeof(T)), &got[b]});
+    };
+    read(0, 0);
+    bool ok{true};
+    for (long at = 0, b = 0; at < n; at += chunk, b ^= 1) {
+      long m{std::min(chunk, n - at)};
+      if (io.wait(got[b]) != m * long(sizeof(T))) {
+        ok = false;
+        break;
+      }
+      if (at + m < n) {
+        io.wait(wrote[b ^ 1]);
+        read(b ^ 1, at + m);
+      }
+      // 最后一块不满时只排前m个, 不另开缓冲, 内存不超过预算
+      SimdSort<T>::sort(buf[b], 0, int(m) - 1, *pool);
+      if (wrote[b] < 0) {
+        ok = false;
+        break;
+      }
+      io.submit({tmp, true, bytes(buf[b]), m * long(sizeof(T)),
+                 at * long(sizeof(T)), &wrote[b]});
+      all.push_back(Run{at, m});
+      progress.advance(m * long(sizeof(T)));
+    }
+    // 退出前等所有请求完成, 缓冲区才能释放
+    for (int b = 0; b < 2; ++b)
+      ok = io.wait(got[b]) >= 0 && io.wait(wrote[b]) >= 0 && ok;
+    runs = all.size();
+    return ok;
+  }
+
+  // 输入段all[i, j)归并写到dst中从at起的位置(元素)
+  bool merge(int src, const ns::vector<Run> &all, int i, int j, int dst,
+             long at, Progress &progress) {
+    int k{j - i};
+    long B{std::max(1L, block() / long(sizeof(T)))};
+    // cur是正在归并的块, 另一块back在后台预读文件中的next
+    struct Input {
+      ns::vector<T> buf[2];
+      T *cur, *end;
+      int back;
+      long next, left, got;
+    };
+    ns::vector<Input> in(k);
+    bool ok{true};
+    auto prefetch = [&](Input &s) {
+      long m{std::min(B, s.left)};
+      s.got = 0;
+      if (m > 0)
+        io.submit({src, false, bytes(s.buf[s.back]), m * long(sizeof(T)),
+                   s.next * long(sizeof(T)), &s.got});
+      s.next += m, s.left -= m;
+    };
+    // 切换到预读好的块, 段读完时cur == end
+    auto advance = [&](Input &s) {
+      long got{io.wait(s.got)};
+      ok = ok && got >= 0 && got % sizeof(T) == 0;
+      if (got <= 0)
+        return;
+      s.cur = s.buf[s.back].begin(), s.end = s.cur + got / sizeof(T);
+      s.back ^= 1;
+      prefetch(s);
+    };
+    long total{0};
+    for (int r = 0; r < k; ++r) {
+      Input &s{in[r]};
+      s.buf[0] = ns::vector<T>(int(B)), s.buf[1] = ns::vector<T>(int(B));
+      s.cur = s.end = nullptr, s.back = 0;
+      s.next = all[i + r].at, s.left = all[i + r].n;
+      total += s.left;
+      prefetch(s);
+    }
+    for (Input &s : in)
+      advance(s);
+
+    ns::vector<T> out[2]{ns::vector<T>(int(B)), ns::vector<T>(int(B))};
+    long wrote[2]{};
+    int o{0};
+    T *put{out[0].begin()};
+    auto flush = [&] {
+      long m{put - out[o].begin()};
+      io.submit({dst, true, bytes(out[o]), m * long(sizeof(T)),
+                 at * long(sizeof(T)), &wrote[o]});
+      at += m;
+      progress.advance(m * long(sizeof(T)));
+      o ^= 1;
+      ok = io.wait(wrote[o]) >= 0 && ok;
+      put = out[o].begin();
+    };
+
+    auto before = [&](int a, int b) {
+      return in[a].cur != in[a].end &&
+             (in[b].cur == in[b].end || *in[a].cur < *in[b].cur);
+    };
+    LoserTree tree(k, before);
+    for (long left = total; left > 0; --left) {
+      Input &s{in[tree.top()]};
+      if (s.cur == s.end) {
+        ok = false;
+        break;
+      }
+      *put++ = *s.cur++;
+      if (s.cur == s.end)
+        advance(s);
+      tree.replay();
+      if (put == out[o].end())
+        flush();
+    }
+    flush();
+    ok = io.wait(wrote[o ^ 1]) >= 0 && ok;
+    for (Input &s : in)
+      ok = io.wait(s.got) >= 0 && ok;
+    return ok;
+  }
+};
+
+template <class T> bool writeFile(const char *path, ns::vector<T> &A) {
+  std::FILE *f{std::fopen(path, "wb")};
+  if (!f)
+    return false;
+  bool ok{std::fwrite(A.begin(), sizeof(T), A.size(), f) == A.size()};
+  return std::fclose(f) == 0 && ok;
+}
+
+template <class T> ns::vector<T> readFile(const char *path) {
+  auto n{std::filesystem::file_size(path) / sizeof(T)};
+  ns::vector<T> A(static_cast<int>(n));
+  std::FILE *f{std::fopen(path, "rb")};
+  std::fread(A.begin(), sizeof(T), n, f);
+  std::fclose(f);
+  return A;
+}
+
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  auto dir{std::filesystem::temp_directory_path()};
+  std::string in{dir / "SortExternal.in"}, out{dir / "SortExternal.out"};
+  // 内存预算为数据量的1/8与1/64, 后者要多趟归并
+  for (auto [name, shrink] : {std::pair{"ExternalSort<1/8>", 8},
+                              std::pair{"ExternalSort<1/64>", 64}})
+    bench.bulk(
+        "sort", name,
+        [&](int n, Dist d) {
+          auto A{benchData(d, n, bench.seed)};
+          writeFile(in.c_str(), A);
+          return n;
+        },
+        [&](int n) {
+          ExternalSort<int> es;
+          es.memory = std::max(4096L, 4L * n / shrink);
+          es.report = nullptr;
+          keep(es.sort(in.c_str(), out.c_str()));
+        },
+        [&](int) {
+          auto A{readFile<int>(out.c_str())};
+          return std::is_sorted(A.begin(), A.end());
+        });
+  std::filesystem::remove(in);
+  std::filesystem::remove(out);
+}
+#else
+// 与std::sort比对, memory很小时段多且要多趟归并
+template <class T>
+void check(ns::vector<T> A, long memory, const std::string &dir,
+           std::FILE *report = nullptr) {
+  std::string in{dir + "/SortExternal.in"}, out{dir + "/SortExternal.out"};
+  [[maybe_unused]] bool ok{writeFile(in.c_str(), A)};
+  assert(ok);
+  ThreadPool pool(3);
+  ExternalSort<T> es;
+  es.memory = memory, es.tmpdir = dir, es.report = report, es.pool = &pool;
+  ok = es.sort(in.c_str(), out.c_str());
+  assert(ok);
+  std::sort(A.begin(), A.end());
+  auto B{readFile<T>(out.c_str())};
+  assert(std::equal(A.begin(), A.end(), B.begin(), B.end()));
+  if (report)
+    std::print(report, "n = {}, memory = {}: {} runs, {} passes\n", A.size(),
+               memory, es.runs, es.passes);
+}
+
+int main() {
+  std::mt19937_64 mt(std::random_device{}());
+  auto dir{std::filesystem::temp_directory_path() / "SortExternal"};
+  std::filesystem::create_directories(dir);
+
+  ns::vector<int> A(1 << 20);
+  for (auto &x : A)
+    x = int(mt());
+  check(A, 1 << 22, dir, stdout);
+  check(A, 1 << 20, dir, stdout);
+  check(A, 1 << 16, dir, stdout);
+
+  for (int n : {0, 1, 2, 1000, 4097, 100000}) {
+    ns::vector<int> few(n);
+    ns::vector<unsigned long long> U(n);
+    ns::vector<double> D(n);
+    for (int i = 0; i < n; ++i)
+      few[i] = mt() % 4, U[i] = mt(), D[i] = double(std::int64_t(mt()));
+    for (long memory : {1 << 12, 1 << 15, 1 << 20}) {
+      check(few, memory, dir);
+      check(U, memory, dir);
+      check(D, memory, dir);
+    }
+  }
+
+  // 长度不是元素大小的整数倍, 输入不存在, 临时目录不存在
+  std::string in{dir / "SortExternal.in"}, out{dir / "SortExternal.out"};
+  std::filesystem::resize_file(in, 6);
+  ExternalSort<int> es;
+  es.memory = 4;
+  assert(!es.sort(in.c_str(), out.c_str()));
+  assert(!es.sort((dir / "missing").c_str(), out.c_str()));
+  std::filesystem::resize_file(in, 64);
+  es.tmpdir = dir / "missing";
+  assert(!es.sort(in.c_str(), out.c_str()));
+  std::filesystem::remove_all(dir);
+}
+#endif
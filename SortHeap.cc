@@ -1,43 +1,19 @@
-#include "vector.hh"
-#include <concepts>
+#include "SortHeap.hh"
+#include <cassert>
 #include <print>
 #include <random>
+#include <string>
 
-/**
- *   (k-1)/2
- *      |
- *      k
- *    /   \
- *  2k+1  2k+2
- */
-
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct heap {
-  static void sort(ns::vector<compar> &pq) {
-    int n{pq.size() - 1};
-    // heapify phase
-    for (int k = (n - 1) / 2; k >= 0; --k)
-      sink(pq, k, n);
-    // sortdown phase
-    while (n > 0) {
-      std::swap(pq[0], pq[n--]);
-      sink(pq, 0, n);
-    }
-  }
-  static void sink(ns::vector<compar> &pq, int k, int n) {
-    while (2 * k + 1 <= n) {
-      int j{2 * k + 1};
-      if (j < n && pq[j] < pq[j + 1])
-        ++j;
-      if (pq[k] >= pq[j])
-        break;
-      std::swap(pq[k], pq[j]);
-      k = j;
-    }
-  }
-};
+#ifdef BENCH
+#include "Bench.hh"
 
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.sort("heap", [](auto &A) { heap<int>::sort(A); });
+  bench.sort("HeapBottomUp<2>", [](auto &A) { HeapBottomUp<int, 2>::sort(A); });
+  bench.sort("HeapBottomUp<4>", [](auto &A) { HeapBottomUp<int, 4>::sort(A); });
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -54,4 +30,36 @@ int main() {
   std::print("\n\n");
   std::print("{}", std::ranges::is_sorted(a) ? "Sorted" : "Unsorted");
   std::print("\n");
-}
\ No newline at end of file
+
+  // 与std::sort比对, 覆盖最后一层孩子不满的各种n
+  auto check = [&]<int D, class T>(ns::vector<T> A) {
+    ns::vector<T> want(A);
+    std::sort(want.begin(), want.end());
+    HeapBottomUp<T, D>::sort(A);
+    assert(std::equal(A.begin(), A.end(), want.begin(), want.end()));
+  };
+  for (int n = 0; n < 300; ++n)
+    for (int shape = 0; shape < 4; ++shape) {
+      ns::vector<int> A(n);
+      for (int i = 0; i < n; ++i)
+        A[i] = shape == 0   ? int(mt())
+               : shape == 1 ? i
+               : shape == 2 ? n - i
+                            : int(mt() % 3);
+      check.operator()<2>(A);
+      check.operator()<4>(A);
+      // 非平凡元素, 覆盖空区间
+      ns::vector<std::string> S(n);
+      for (int i = 0; i < n; ++i)
+        S[i] = std::to_string(A[i]);
+      check.operator()<2>(S);
+      check.operator()<4>(S);
+      HeapBottomUp<std::string>::sort(S, n, n - 1);
+    }
+  ns::vector<int> big(1 << 20);
+  for (auto &x : big)
+    x = int(mt());
+  check.operator()<2>(big);
+  check.operator()<4>(big);
+}
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+#include "vector.hh"
+#include <algorithm>
+#include <concepts>
+
+/**
+ *   (k-1)/2
+ *      |
+ *      k
+ *    /   \
+ *  2k+1  2k+2
+ */
+
+// 对pq[lo..hi]排序时k, n都是相对lo的下标, pq也可以是指针
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct heap {
+  static void sort(ns::vector<compar> &pq) { sort(pq, 0, pq.size() - 1); }
+  template <class Seq> static void sort(Seq &pq, int lo, int hi) {
+    int n{hi - lo};
+    // heapify phase
+    for (int k = (n - 1) / 2; k >= 0; --k)
+      sink(pq, k, n, lo);
+    // sortdown phase
+    while (n > 0) {
+      std::swap(pq[lo], pq[lo + n--]);
+      sink(pq, 0, n, lo);
+    }
+  }
+  template <class Seq> static void sink(Seq &pq, int k, int n, int lo = 0) {
+    while (2 * k + 1 <= n) {
+      int j{2 * k + 1};
+      if (j < n && pq[lo + j] < pq[lo + j + 1])
+        ++j;
+      if (pq[lo + k] >= pq[lo + j])
+        break;
+      std::swap(pq[lo + k], pq[lo + j]);
+      k = j;
+    }
+  }
+};
+
+/**
+ * 自底向上的D叉堆排序(D = 2或4), 就地, 最坏O(n log n)
+ *   Floyd的下沉: 每层只在孩子间比较, 较大者上移, 一路降到叶子留下空位,
+ *   再从叶子往上找被下沉元素的位置; 出堆换上来的元素几乎总回到底层,
+ *   所以往上走不了几步, 比较次数约为经典下沉的一半
+ *   4叉堆层数减半, 兄弟相邻, 每层多半只碰一条缓存行; 下降时预取孙子
+ *
+ *       (k-1)/D
+ *          |
+ *          k
+ *     /    |    \
+ *  Dk+1   ...  Dk+D
+ */
+template <typename compar, int D = 4>
+  requires std::totally_ordered<compar> && (D == 2 || D == 4)
+struct HeapBottomUp {
+  static void sort(ns::vector<compar> &A) { sort(A.begin(), A.size()); }
+  template <class Seq> static void sort(Seq &A, int lo, int hi) {
+    if (hi > lo)
+      sort(&A[lo], hi - lo + 1);
+  }
+  static void sort(compar *a, int n) {
+    // n为0时(n - 2) / D向零取整得0, 会碰a[0]
+    if (n < 2)
+      return;
+    for (int k = (n - 2) / D; k >= 0; --k)
+      sift(a, k, n, compar(a[k]));
+    for (int m = n - 1; m > 0; --m) {
+      compar x{a[m]};
+      a[m] = a[0];
+      sift(a, 0, m, x);
+    }
+  }
+
+  // a[k]是空位, 把x放进以k为根的子堆, 堆大小为n
+  static void sift(compar *a, int k, int n, compar x) {
+    int hole{k}, c;
+    while ((c = D * hole + 1) + D <= n) {
+      if (D * c + 1 < n) {
+        __builtin_prefetch(a + D * c + 1);
+        __builtin_prefetch(a + D * c + D * D);
+      }
+      a[hole] = a[c = largest(a, c)];
+      hole = c;
+    }
+    // 最后一层孩子不满
+    if (c < n) {
+      int m{c};
+      for (int i = c + 1; i < n; ++i)
+        if (a[m] < a[i])
+          m = i;
+      a[hole] = a[m];
+      hole = m;
+    }
+    for (int p; hole > k && a[p = (hole - 1) / D] < x; hole = p)
+      a[hole] = a[p];
+    a[hole] = x;
+  }
+
+  // a[c, c + D)中最大的下标, 比较结果直接加到下标上, 不用分支
+  static int largest(const compar *a, int c) {
+    if constexpr (D == 2)
+      return c + (a[c] < a[c + 1]);
+    else {
+      int l{c + (a[c] < a[c + 1])}, r{c + 2 + (a[c + 2] < a[c + 3])};
+      return l + (r - l) * (a[l] < a[r]);
+    }
+  }
+};
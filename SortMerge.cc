@@ -1,112 +1,7 @@
-#include "vector.hh"
-#include <algorithm>
-#include <concepts>
+#include "SortMerge.hh"
 #include <print>
 #include <random>
 
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct MergeTD {
-  static void sort(ns::vector<compar> &a) {
-    ns::vector<compar> aux(a.size());
-    sort(a, aux, 0, a.size() - 1);
-  }
-  static void sort(ns::vector<compar> &a, ns::vector<compar> &aux, int lo,
-                   int hi) {
-    if (lo >= hi)
-      return;
-    int mid{lo + (hi - lo) / 2};
-    sort(a, aux, lo, mid);
-    sort(a, aux, mid + 1, hi);
-    merge(a, aux, lo, mid, hi);
-  }
-  static void merge(ns::vector<compar> &a, ns::vector<compar> &aux, int lo,
-                    int mid, int hi) {
-    for (int k = lo; k <= hi; ++k)
-      aux[k] = a[k];
-
-    int i{lo}, j{mid + 1};
-    for (int k = lo; k <= hi; ++k)
-      if (i > mid)
-        a[k] = aux[j++];
-      else if (j > hi)
-        a[k] = aux[i++];
-      else if (aux[j] < aux[i])
-        a[k] = aux[j++];
-      // aux[j] >= aux[i]
-      else
-        a[k] = aux[i++];
-  }
-};
-
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct MergeBU {
-  static void sort(ns::vector<compar> &a) {
-    int n = a.size();
-    ns::vector<compar> aux(n);
-    for (int len = 1; len < n; len = len + len) {
-      for (int lo = 0; lo < n - len; lo += len + len) {
-        int mid{lo + len - 1};
-        int hi{std::min(lo + len + len - 1, n - 1)};
-
-        for (int k = lo; k <= hi; ++k)
-          aux[k] = a[k];
-
-        int i{lo}, j{mid + 1};
-        for (int k = lo; k <= hi; ++k) {
-          if (i > mid)
-            a[k] = aux[j++];
-          else if (j > hi)
-            a[k] = aux[i++];
-          else if (aux[j] < aux[i])
-            a[k] = aux[j++];
-          // aux[j] >= aux[i]
-          else
-            a[k] = aux[i++];
-        }
-      }
-    }
-  }
-};
-
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct Merge408 {
-  static void sort(ns::vector<compar> &a) {
-    ns::vector<compar> aux(a.size());
-    sort(a, aux, 0, a.size() - 1);
-  }
-  static void sort(ns::vector<compar> &a, ns::vector<compar> &aux, int low,
-                   int high) {
-    if (high <= low)
-      return;
-    int mid{low + (high - low) / 2};
-    sort(a, aux, low, mid);
-    sort(a, aux, mid + 1, high);
-    merge(a, aux, low, mid, high);
-  }
-  static void merge(ns::vector<compar> &a, ns::vector<compar> &aux, int low,
-                    int mid, int high) {
-    for (int k = low; k <= high; ++k)
-      aux[k] = a[k];
-    int i{low}, j{mid + 1}, k{low};
-    while (i <= mid && j <= high) {
-      if (aux[i] <= aux[j])
-        a[k] = aux[i++];
-      else
-        a[k] = aux[j++];
-      ++k;
-    }
-    while (i <= mid)
-      a[k++] = aux[i++];
-    /*
-    while (j <= high)
-      a[k++] = aux[j++];
-    */
-  }
-};
-
 template <class S, class T> void printSort(ns::vector<T> A) {
   S::sort(A);
   std::ranges::for_each(A, [](auto x) { std::print("{}\t", x); });
@@ -115,6 +10,18 @@ template <class S, class T> void printSort(ns::vector<T> A) {
   std::print("\n\n");
 }
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.sort("MergeTD", [](auto &A) { MergeTD<int>::sort(A); });
+  bench.sort("MergeBU", [](auto &A) { MergeBU<int>::sort(A); });
+  bench.sort("Merge408", [](auto &A) { Merge408<int>::sort(A); });
+  bench.sort("TimSort", [](auto &A) { TimSort<int>::sort(A); });
+  bench.sort("MergeMultiway", [](auto &A) { MergeMultiway<int>::sort(A); });
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -136,4 +43,39 @@ int main() {
   std::print("Merge408\n");
   printSort<Merge408<int>, int>(A);
   printSort<Merge408<int>, int>({4, 4, 4, 4});
-}
\ No newline at end of file
+
+  std::print("TimSort\n");
+  printSort<TimSort<int>, int>(A);
+  printSort<TimSort<int>, int>({4, 4, 4, 4});
+
+  // 与std::stable_sort比对: 键相同的按原下标排
+  struct Item {
+    int key, id;
+    auto operator<=>(const Item &o) const { return key <=> o.key; }
+    bool operator==(const Item &o) const { return key == o.key; }
+  };
+  ThreadPool pool(4);
+  auto check = [&](int n, auto gen) {
+    ns::vector<Item> B(n), C(n), want(n);
+    for (int i = 0; i < n; ++i)
+      B[i] = C[i] = want[i] = {gen(i), i};
+    std::stable_sort(want.begin(), want.end());
+    TimSort<Item>::sort(B);
+    MergeMultiway<Item>::sort(C, pool);
+    for (int i = 0; i < n; ++i)
+      assert(B[i].key == want[i].key && B[i].id == want[i].id &&
+             C[i].key == want[i].key && C[i].id == want[i].id);
+  };
+  for (int n : {0, 1, 2, 63, 64, 65, 200, 1000, 1 << 18}) {
+    check(n, [&](int) { return int(mt()); });
+    check(n, [&](int) { return int(mt() % 4); });
+    check(n, [&](int i) { return i; });
+    check(n, [&](int i) { return -i / 3; });
+    // 锯齿, 长短不一的有序段, 偶尔有乱序
+    check(n, [&](int i) { return i % 1000 + i % 37; });
+    check(n, [&](int i) { return mt() % 100 ? i : int(mt() % n); });
+    // 值域互不重叠的长段, 合并时整块胜出, 走飞奔模式
+    check(n, [&](int i) { return i / 5000 * 7919 % 97 * 100000 + i % 5000; });
+  }
+}
+#endif
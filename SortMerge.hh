@@ -0,0 +1,460 @@
+#pragma once
+#include "SortSlow.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <numeric>
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct MergeTD {
+  static void sort(ns::vector<compar> &a) {
+    ns::vector<compar> aux(a.size());
+    sort(a, aux, 0, a.size() - 1);
+  }
+  static void sort(ns::vector<compar> &a, ns::vector<compar> &aux, int lo,
+                   int hi) {
+    if (lo >= hi)
+      return;
+    int mid{lo + (hi - lo) / 2};
+    sort(a, aux, lo, mid);
+    sort(a, aux, mid + 1, hi);
+    merge(a, aux, lo, mid, hi);
+  }
+  static void merge(ns::vector<compar> &a, ns::vector<compar> &aux, int lo,
+                    int mid, int hi) {
+    for (int k = lo; k <= hi; ++k)
+      aux[k] = a[k];
+
+    int i{lo}, j{mid + 1};
+    for (int k = lo; k <= hi; ++k)
+      if (i > mid)
+        a[k] = aux[j++];
+      else if (j > hi)
+        a[k] = aux[i++];
+      else if (aux[j] < aux[i])
+        a[k] = aux[j++];
+      // aux[j] >= aux[i]
+      else
+        a[k] = aux[i++];
+  }
+};
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct MergeBU {
+  static void sort(ns::vector<compar> &a) {
+    int n = a.size();
+    ns::vector<compar> aux(n);
+    for (int len = 1; len < n; len = len + len) {
+      for (int lo = 0; lo < n - len; lo += len + len) {
+        int mid{lo + len - 1};
+        int hi{std::min(lo + len + len - 1, n - 1)};
+
+        for (int k = lo; k <= hi; ++k)
+          aux[k] = a[k];
+
+        int i{lo}, j{mid + 1};
+        for (int k = lo; k <= hi; ++k) {
+          if (i > mid)
+            a[k] = aux[j++];
+          else if (j > hi)
+            a[k] = aux[i++];
+          else if (aux[j] < aux[i])
+            a[k] = aux[j++];
+          // aux[j] >= aux[i]
+          else
+            a[k] = aux[i++];
+        }
+      }
+    }
+  }
+};
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct Merge408 {
+  static void sort(ns::vector<compar> &a) {
+    ns::vector<compar> aux(a.size());
+    sort(a, aux, 0, a.size() - 1);
+  }
+  static void sort(ns::vector<compar> &a, ns::vector<compar> &aux, int low,
+                   int high) {
+    if (high <= low)
+      return;
+    int mid{low + (high - low) / 2};
+    sort(a, aux, low, mid);
+    sort(a, aux, mid + 1, high);
+    merge(a, aux, low, mid, high);
+  }
+  static void merge(ns::vector<compar> &a, ns::vector<compar> &aux, int low,
+                    int mid, int high) {
+    for (int k = low; k <= high; ++k)
+      aux[k] = a[k];
+    int i{low}, j{mid + 1}, k{low};
+    while (i <= mid && j <= high) {
+      if (aux[i] <= aux[j])
+        a[k] = aux[i++];
+      else
+        a[k] = aux[j++];
+      ++k;
+    }
+    while (i <= mid)
+      a[k++] = aux[i++];
+    /*
+    while (j <= high)
+      a[k++] = aux[j++];
+    */
+  }
+};
+
+/**
+ * 自适应归并排序(TimSort), 稳定
+ *   扫描自然有序段, 严格降序段就地翻转, 短段用折半插入补到minRun
+ *   段压入栈, 栈顶几段长度不满足近似斐波那契关系时合并
+ *   合并时只把较短的一段拷进缓冲区, 缓冲区为n/2
+ *   一方连续胜出minGallop次后进入飞奔模式, 指数搜索整块搬动
+ */
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct TimSort {
+  static constexpr int MIN_GALLOP{7};
+  struct Run {
+    int base, len;
+  };
+  ns::vector<compar> &a;
+  ns::vector<compar> tmp;
+  // 段长至少按斐波那契数增长, 85层足够2^31个元素
+  Run runs[85];
+  int stack{0}, minGallop{MIN_GALLOP};
+
+  TimSort(ns::vector<compar> &a, int n) : a{a}, tmp(n / 2) {}
+
+  static void sort(ns::vector<compar> &a) { sort(a, 0, a.size() - 1); }
+  static void sort(ns::vector<compar> &a, int first, int last) {
+    int n{last - first + 1};
+    if (n < 2)
+      return;
+    TimSort ts(a, n);
+    int minRun{minRunLength(n)};
+    for (int lo = first; lo <= last;) {
+      int len{ts.countRun(lo, last + 1)};
+      if (len < minRun) {
+        int force{std::min(minRun, last + 1 - lo)};
+        leftBisectionInsertion(a, lo, lo + force - 1, lo + len);
+        len = force;
+      }
+      ts.runs[ts.stack++] = {lo, len};
+      ts.mergeCollapse();
+      lo += len;
+    }
+    while (ts.stack > 1) {
+      int i{ts.stack - 2};
+      if (i > 0 && ts.runs[i - 1].len < ts.runs[i + 1].len)
+        --i;
+      ts.mergeAt(i);
+    }
+  }
+
+  // n < 64时就是n, 否则取n的高6位, 有余数再加1, 使n/minRun接近2的幂
+  static int minRunLength(int n) {
+    int r{0};
+    for (; n >= 64; n >>= 1)
+      r |= n & 1;
+    return n + r;
+  }
+
+  // 从lo起到n为止的有序段长度, 严格降序段翻转成升序, 保持稳定
+  int countRun(int lo, int n) {
+    int hi{lo + 1};
+    if (hi == n)
+      return 1;
+    if (a[hi++] < a[lo]) {
+      while (hi < n && a[hi] < a[hi - 1])
+        ++hi;
+      std::reverse(&a[lo], &a[0] + hi);
+    } else
+      while (hi < n && !(a[hi] < a[hi - 1]))
+        ++hi;
+    return hi - lo;
+  }
+
+  // 保持runs[i-2] > runs[i-1] + runs[i]且runs[i-1] > runs[i]
+  void mergeCollapse() {
+    while (stack > 1) {
+      int i{stack - 2};
+      if ((i > 0 && runs[i - 1].len <= runs[i].len + runs[i + 1].len) ||
+          (i > 1 && runs[i - 2].len <= runs[i - 1].len + runs[i].len)) {
+        if (runs[i - 1].len < runs[i + 1].len)
+          --i;
+      } else if (runs[i].len > runs[i + 1].len)
+        break;
+      mergeAt(i);
+    }
+  }
+
+  /**
+   * p[0, len)中在key之前的元素个数, 从hint起指数搜索再二分
+   * right为false时相等的元素算在key之后(即下界), 为true时算在之前(即上界)
+   */
+  template <bool right>
+  static int gallop(const compar &key, const compar *p, int len, int hint) {
+    auto before = [&](int i) { return right ? !(key < p[i]) : p[i] < key; };
+    // 答案在(lo, hi]中
+    int lo, hi;
+    if (before(hint)) {
+      int ofs{1};
+      lo = hint;
+      while (ofs < len - hint && before(hint + ofs))
+        lo = hint + ofs, ofs = 2 * ofs + 1;
+      hi = std::min(hint + ofs, len);
+    } else {
+      int ofs{1};
+      hi = hint;
+      while (ofs <= hint && !before(hint - ofs))
+        hi = hint - ofs, ofs = 2 * ofs + 1;
+      lo = std::max(hint - ofs, -1);
+    }
+    while (hi - lo > 1) {
+      int mid{lo + (hi - lo) / 2};
+      (before(mid) ? lo : hi) = mid;
+    }
+    return hi;
+  }
+
+  void mergeAt(int i) {
+    auto [base1, len1] = runs[i];
+    auto [base2, len2] = runs[i + 1];
+    runs[i].len = len1 + len2;
+    if (i == stack - 3)
+      runs[i + 1] = runs[i + 2];
+    --stack;
+    // 第一段中不大于第二段首元素的, 第二段中不小于第一段尾元素的, 都已就位
+    int k{gallop<true>(a[base2], &a[base1], len1, 0)};
+    base1 += k, len1 -= k;
+    if (len1 == 0)
+      return;
+    len2 = gallop<false>(a[base1 + len1 - 1], &a[base2], len2, len2 - 1);
+    if (len2 == 0)
+      return;
+    len1 <= len2 ? mergeLo(base1, len1, base2, len2)
+                 : mergeHi(base1, len1, base2, len2);
+  }
+
+  // 第一段较短, 拷进tmp后从前往后合并
+  void mergeLo(int base1, int len1, int base2, int len2) {
+    compar *t{&tmp[0]};
+    std::copy(&a[base1], &a[base1] + len1, t);
+    int i{0}, j{base2}, k{base1}, end2{base2 + len2};
+    [&] {
+      while (true) {
+        int count1{0}, count2{0};
+        do
+          if (a[j] < t[i]) {
+            a[k++] = a[j++], ++count2, count1 = 0;
+            if (j == end2)
+              return;
+          } else {
+            a[k++] = t[i++], ++count1, count2 = 0;
+            if (i == len1)
+              return;
+          }
+        while ((count1 | count2) < minGallop);
+        do {
+          count1 = gallop<true>(a[j], t + i, len1 - i, 0);
+          k = std::copy(t + i, t + i + count1, &a[k]) - &a[0];
+          if ((i += count1) == len1)
+            return;
+          a[k++] = a[j++];
+          if (j == end2)
+            return;
+          count2 = gallop<false>(t[i], &a[j], end2 - j, 0);
+          k = std::copy(&a[j], &a[j] + count2, &a[k]) - &a[0];
+          if ((j += count2) == end2)
+            return;
+          a[k++] = t[i++];
+          if (i == len1)
+            return;
+          --minGallop;
+        } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+        minGallop = std::max(minGallop, 0) + 2;
+      }
+    }();
+    // 第二段剩下的已经就位
+    std::copy(t + i, t + len1, &a[k]);
+  }
+
+  // 第二段较短, 拷进tmp后从后往前合并
+  void mergeHi(int base1, int len1, int base2, int len2) {
+    compar *t{&tmp[0]};
+    std::copy(&a[base2], &a[base2] + len2, t);
+    int i{base1 + len1 - 1}, j{len2 - 1}, k{base2 + len2 - 1};
+    [&] {
+      while (true) {
+        int count1{0}, count2{0};
+        do
+          if (t[j] < a[i]) {
+            a[k--] = a[i--], ++count1, count2 = 0;
+            if (i < base1)
+              return;
+          } else {
+            a[k--] = t[j--], ++count2, count1 = 0;
+            if (j < 0)
+              return;
+          }
+        while ((count1 | count2) < minGallop);
+        do {
+          int left{i - base1 + 1};
+          count1 = left - gallop<true>(t[j], &a[base1], left, left - 1);
+          std::copy_backward(&a[i - count1 + 1], &a[i] + 1, &a[k] + 1);
+          k -= count1;
+          if ((i -= count1) < base1)
+            return;
+          a[k--] = t[j--];
+          if (j < 0)
+            return;
+          count2 = j + 1 - gallop<false>(a[i], t, j + 1, j);
+          std::copy(t + j - count2 + 1, t + j + 1, &a[k - count2 + 1]);
+          k -= count2;
+          if ((j -= count2) < 0)
+            return;
+          a[k--] = a[i--];
+          if (i < base1)
+            return;
+          --minGallop;
+        } while (count1 >= MIN_GALLOP || count2 >= MIN_GALLOP);
+        minGallop = std::max(minGallop, 0) + 2;
+      }
+    }();
+    // 第一段剩下的已经就位
+    std::copy(t, t + j + 1, &a[k - j]);
+  }
+};
+
+/**
+ * 败者树, k路任意
+ *   叶子i在k+i, tree[x]是以x为根那场比赛的败者, tree[0]是总的胜者
+ *   before(i, j)为真时第i路的当前元素排在第j路前面
+ * 胜者那一路前进后只需沿叶子到根重赛一次, 每层比较一次
+ */
+template <class Before> struct LoserTree {
+  int k;
+  Before before;
+  ns::vector<int> tree;
+
+  LoserTree(int k, Before before) : k{k}, before{before}, tree(k) {
+    tree[0] = k == 1 ? 0 : build(1);
+  }
+  int build(int x) {
+    if (x >= k)
+      return x - k;
+    int a{build(2 * x)}, b{build(2 * x + 1)};
+    if (before(a, b))
+      return tree[x] = b, a;
+    return tree[x] = a, b;
+  }
+  int top() const { return tree[0]; }
+  void replay() {
+    int s{tree[0]};
+    for (int p = (s + k) / 2; p > 0; p /= 2)
+      if (before(tree[p], s))
+        std::swap(tree[p], s);
+    tree[0] = s;
+  }
+};
+
+/**
+ * 并行多路归并排序, 稳定
+ *   k个线程各用TimSort排好自己的一段, 再只用一趟k路归并
+ *   按输出位置把归并切成k份(多序列划分, 归并路径的推广), 每个线程
+ *   用败者树归并自己那份, 写入互不相交的输出区间
+ */
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct MergeMultiway {
+  static void sort(ns::vector<compar> &a,
+                   ThreadPool &pool = ThreadPool::global()) {
+    int n{a.size()}, k{pool.size()};
+    if (k == 1 || n < (1 << 16))
+      return TimSort<compar>::sort(a);
+    ns::vector<int> bound(k + 1);
+    for (int t = 0; t <= k; ++t)
+      bound[t] = long(n) * t / k;
+    pool.run([&](int t) {
+      TimSort<compar>::sort(a, bound[t], bound[t + 1] - 1);
+    });
+    ns::vector<compar> aux(n);
+    pool.run([&](int t) {
+      merge(a, aux, bound, split(a, bound, bound[t]),
+            split(a, bound, bound[t + 1]));
+    });
+    std::swap(a, aux);
+  }
+
+  /**
+   * 第i段[bound[i], bound[i+1])都已有序, 求合并后前r个元素在各段中的结尾
+   * 相等的元素段号小的在前, 每轮取窗口最大的一段的中位元素x, 算出x之前
+   * 的元素个数, 不足r则各段的切点都不在x之前, 否则都不在x之后
+   */
+  static ns::vector<int> split(const ns::vector<compar> &a,
+                               const ns::vector<int> &bound, int r) {
+    int k{bound.size() - 1};
+    ns::vector<int> lo(k), hi(k), cut(k);
+    for (int i = 0; i < k; ++i)
+      lo[i] = bound[i], hi[i] = bound[i + 1];
+    while (true) {
+      int j{0};
+      for (int i = 1; i < k; ++i)
+        if (hi[i] - lo[i] > hi[j] - lo[j])
+          j = i;
+      if (hi[j] == lo[j])
+        return lo;
+      int m{lo[j] + (hi[j] - lo[j]) / 2};
+      const compar &x{a[m]};
+      long rank{0};
+      for (int i = 0; i < k; ++i) {
+        const compar *first{a.begin() + bound[i]};
+        const compar *last{a.begin() + bound[i + 1]};
+        cut[i] = i < j    ? std::upper_bound(first, last, x) - a.begin()
+                 : i == j ? m
+                          : std::lower_bound(first, last, x) - a.begin();
+        rank += cut[i] - bound[i];
+      }
+      if (rank < r) {
+        for (int i = 0; i < k; ++i)
+          lo[i] = std::max(lo[i], cut[i]);
+        lo[j] = m + 1;
+      } else
+        for (int i = 0; i < k; ++i)
+          hi[i] = std::min(hi[i], cut[i]);
+    }
+  }
+
+  // 把各段的[from[i], to[i])归并到aux中对应的位置
+  static void merge(const ns::vector<compar> &a, ns::vector<compar> &aux,
+                    const ns::vector<int> &bound, const ns::vector<int> &from,
+                    const ns::vector<int> &to) {
+    int k{from.size()}, out{0};
+    ns::vector<const compar *> cur(k), end(k);
+    for (int i = 0; i < k; ++i) {
+      cur[i] = a.begin() + from[i], end[i] = a.begin() + to[i];
+      out += from[i] - bound[i];
+    }
+    auto before = [&](int i, int j) {
+      if (cur[i] == end[i])
+        return false;
+      if (cur[j] == end[j] || *cur[i] < *cur[j])
+        return true;
+      return i < j && !(*cur[j] < *cur[i]);
+    };
+    LoserTree tree(k, before);
+    for (int last = out + std::accumulate(to.begin(), to.end(), 0) -
+                    std::accumulate(from.begin(), from.end(), 0);
+         out < last; ++out) {
+      int w{tree.top()};
+      aux[out] = *cur[w]++;
+      tree.replay();
+    }
+  }
+};
@@ -1,159 +1,7 @@
-#include "vector.hh"
-#include <algorithm>
-#include <cassert>
-#include <concepts>
+#include "SortQuick.hh"
 #include <print>
 #include <random>
 
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct Quick226 {
-  static void sort(ns::vector<compar> &A) {
-    std::ranges::shuffle(A, std::mt19937(std::random_device{}()));
-    sort(A, 0, A.size() - 1);
-  }
-  static void sort(ns::vector<compar> &A, int lo, int hi) {
-    if (lo >= hi)
-      return;
-    int p{partition113(A, lo, hi)};
-    sort(A, lo, p - 1);
-    sort(A, p + 1, hi);
-  }
-
-  static int partition226(ns::vector<compar> &A, int lo, int hi) {
-    int i{lo}, j{hi + 1};
-    while (true) {
-      while (A[--j] > A[lo])
-        if (j == lo)
-          break;
-      while (A[++i] < A[lo])
-        if (i == hi)
-          break;
-      if (i >= j)
-        break;
-      std::swap(A[i], A[j]);
-    }
-    assert(i == j || i - j == 1);
-    std::swap(A[lo], A[j]);
-    return j;
-  }
-
-  static int partition113(ns::vector<compar> &A, int lo, int hi) {
-    int i{lo}, j{hi + 1};
-    while (true) {
-      do
-        i++;
-      while (A[i] < A[lo] && i < hi);
-      do
-        j--;
-      while (A[j] > A[lo] && j > lo);
-      if (i >= j)
-        break;
-      std::swap(A[i], A[j]);
-    }
-    assert(i == j || i - j == 1);
-    std::swap(A[lo], A[j]);
-    return j;
-  }
-};
-
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct Quick408 {
-  static void sort(ns::vector<compar> &A) {
-    std::ranges::shuffle(A, std::mt19937(std::random_device{}()));
-    sort(A, 0, A.size() - 1);
-  }
-  static void sort(ns::vector<compar> &A, int lo, int hi) {
-    if (lo >= hi)
-      return;
-    int p{partition912(A, lo, hi)};
-    sort(A, lo, p - 1);
-    sort(A, p + 1, hi);
-  }
-
-  static int partition408(ns::vector<compar> &A, int lo, int hi) {
-    compar pivot{A[lo]};
-    do {
-      while (lo < hi && A[hi] >= pivot)
-        --hi;
-      A[lo] = A[hi];
-      while (lo < hi && A[lo] <= pivot)
-        ++lo;
-      A[hi] = A[lo];
-    } while (lo < hi);
-    assert(lo == hi);
-    A[lo] = pivot;
-    return lo;
-  }
-
-  static int partition660(ns::vector<compar> &A, int lo, int hi) {
-    compar pivot{A[lo]};
-    do {
-      while (lo < hi && A[hi] > pivot)
-        --hi;
-      if (lo < hi)
-        A[lo++] = A[hi];
-      while (lo < hi && A[lo] < pivot)
-        ++lo;
-      if (lo < hi)
-        A[hi--] = A[lo];
-    } while (lo < hi);
-    assert(lo == hi);
-    A[lo] = pivot;
-    return lo;
-  }
-
-  static int partition912(ns::vector<compar> &A, int lo, int hi) {
-    compar pivot{A[lo]};
-    do {
-      while (lo < hi)
-        if (A[hi] > pivot)
-          --hi;
-        else {
-          A[lo++] = A[hi];
-          break;
-        }
-      while (lo < hi)
-        if (A[lo] < pivot)
-          ++lo;
-        else {
-          A[hi--] = A[lo];
-          break;
-        }
-    } while (lo < hi);
-    assert(lo == hi);
-    A[lo] = pivot;
-    return lo;
-  }
-};
-
-template <typename compar>
-  requires std::totally_ordered<compar>
-struct Quick3way {
-  static void sort(ns::vector<compar> &A) {
-    std::ranges::shuffle(A, std::mt19937(std::random_device{}()));
-    sort(A, 0, A.size() - 1);
-  }
-  static void sort(ns::vector<compar> &A, int lo, int hi) {
-    if (lo >= hi)
-      return;
-    int lt{lo}, gt{hi};
-    compar pivot{A[lo]};
-    int i{lo + 1};
-    while (i <= gt) {
-      if (A[i] < pivot)
-        std::swap(A[lt++], A[i++]);
-      else if (A[i] > pivot)
-        std::swap(A[i], A[gt--]);
-      else if (A[i] == pivot)
-        ++i;
-    }
-    sort(A, lo, lt - 1);
-    sort(A, gt + 1, hi);
-  }
-};
-
 template <class S, class T> void printSort(ns::vector<T> A) {
   S::sort(A);
   std::ranges::for_each(A, [](auto x) { std::print("{}\t", x); });
@@ -162,6 +10,39 @@ template <class S, class T> void printSort(ns::vector<T> A) {
   std::print("\n\n");
 }
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.sort("Quick226", [](auto &A) { Quick226<int>::sort(A); });
+  bench.sort("Quick408", [](auto &A) { Quick408<int>::sort(A); });
+  bench.sort("Quick3way", [](auto &A) { Quick3way<int>::sort(A); });
+  bench.sort("Quick226<block>",
+             [](auto &A) { Quick226<int, Partition::block>::sort(A); });
+  bench.sort("Quick3way<block>",
+             [](auto &A) { Quick3way<int, Partition::block>::sort(A); });
+  bench.sort("IntroSort", [](auto &A) { IntroSort<int>::sort(A); });
+  bench.sort("IntroSort<block>",
+             [](auto &A) { IntroSort<int, Partition::block>::sort(A); });
+
+  // 单次切分整个数组, 直接比较各切分的分支开销
+  auto partition = [&](std::string_view name, auto f) {
+    bench.bulk(
+        "partition", name,
+        [&](int n, Dist d) { return benchData(d, n, bench.seed); },
+        [&](ns::vector<int> &A) { keep(f(A, 0, A.size() - 1)); },
+        [](ns::vector<int> &) { return true; });
+  };
+  partition("partition226", Quick226<int>::partition226);
+  partition("partition113", Quick226<int>::partition113);
+  partition("partition912", Quick408<int>::partition912);
+  partition("partitionBlock", Quick226<int>::partitionBlock);
+  partition("Quick3way::partition", Quick3way<int>::partition);
+  partition("Quick3way<block>::partition",
+            Quick3way<int, Partition::block>::partition);
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(10, 99);
@@ -179,4 +60,52 @@ int main() {
   std::print("Quick408\n");
   printSort<Quick408<int>, int>(A);
   printSort<Quick408<int>, int>({4, 4, 4, 4});
-}
\ No newline at end of file
+
+  std::print("Quick226<block>\n");
+  printSort<Quick226<int, Partition::block>, int>(A);
+  printSort<Quick226<int, Partition::block>, int>({4, 4, 4, 4});
+
+  std::print("Quick3way<block>\n");
+  printSort<Quick3way<int, Partition::block>, int>(A);
+
+  std::print("IntroSort\n");
+  printSort<IntroSort<int>, int>(A);
+
+  // 大数组在4线程上与std::sort比对: 随机, 有序, 逆序, 大量重复
+  ThreadPool pool(4);
+  constexpr int n{1 << 20};
+  ns::vector<int> big(n), want(n);
+  for (int shape = 0; shape < 4; ++shape) {
+    for (int i = 0; i < n; ++i)
+      big[i] = shape == 0   ? int(mt())
+               : shape == 1 ? i
+               : shape == 2 ? n - i
+                            : mt() % 16;
+    std::copy(big.begin(), big.end(), want.begin());
+    std::sort(want.begin(), want.end());
+    ns::vector<int> block(big);
+    IntroSort<int>::sort(big, pool);
+    assert(std::equal(big.begin(), big.end(), want.begin()));
+    IntroSort<int, Partition::block>::sort(block, pool);
+    assert(std::equal(block.begin(), block.end(), want.begin()));
+  }
+  // 分块切分的边界: 左边都不大于枢轴, 右边都不小于枢轴
+  for (int sz : {2, 127, 128, 129, 1000}) {
+    ns::vector<int> C(sz);
+    for (auto &e : C)
+      e = mt() % 8;
+    int p{Quick226<int>::partitionBlock(C, 0, sz - 1)};
+    assert(std::all_of(&C[0], &C[p], [&](int x) { return x <= C[p]; }));
+    assert(std::all_of(&C[p], &C[0] + sz, [&](int x) { return x >= C[p]; }));
+    auto [lt, gt]{Quick3way<int, Partition::block>::partition(C, 0, sz - 1)};
+    assert(std::all_of(&C[0], &C[lt], [&](int x) { return x < C[lt]; }));
+    assert(std::all_of(&C[lt], &C[gt] + 1, [&](int x) { return x == C[lt]; }));
+    assert(
+        std::all_of(&C[gt] + 1, &C[0] + sz, [&](int x) { return x > C[lt]; }));
+  }
+  // 深度耗尽时退化为堆排序
+  std::ranges::shuffle(big, mt);
+  IntroSort<int>::serial(big, {0, n - 1, 0});
+  assert(std::equal(big.begin(), big.end(), want.begin()));
+}
+#endif
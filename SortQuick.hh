@@ -0,0 +1,303 @@
+#pragma once
+#include "SortHeap.hh"
+#include "SortSlow.hh"
+#include "ThreadPool.hh"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <concepts>
+#include <functional>
+#include <random>
+
+/**
+ * BlockQuicksort分块切分A[lo..hi], 返回k: [lo,k)不属于右边, [k,hi]不属于左边
+ *   left(x)   x可以留在左边, 否则左块里的x放错了边
+ *   right(x)  x可以留在右边
+ * 左右各取一块, 先把放错边的偏移无分支地写进数组, 再成对交换,
+ * 比较结果不参与跳转, 随机数据上不会有一半的分支预测失败
+ */
+template <class T, class Left, class Right>
+int blockPartition(ns::vector<T> &A, int lo, int hi, Left left, Right right) {
+  constexpr int B{64};
+  unsigned char offL[B], offR[B];
+  int l{lo}, r{hi + 1}, nL{0}, nR{0}, sL{0}, sR{0};
+  // 左块[l, l+B)与右块[r-B, r)不重叠
+  while (r - l >= 2 * B) {
+    if (nL == 0) {
+      sL = 0;
+      for (int i = 0; i < B; ++i) {
+        offL[nL] = i;
+        nL += !left(A[l + i]);
+      }
+    }
+    if (nR == 0) {
+      sR = 0;
+      for (int i = 0; i < B; ++i) {
+        offR[nR] = i;
+        nR += !right(A[r - 1 - i]);
+      }
+    }
+    int m{std::min(nL, nR)};
+    for (int k = 0; k < m; ++k)
+      std::swap(A[l + offL[sL + k]], A[r - 1 - offR[sR + k]]);
+    nL -= m, nR -= m, sL += m, sR += m;
+    if (nL == 0)
+      l += B;
+    if (nR == 0)
+      r -= B;
+  }
+  // 剩下不足两块, 逐个扫描
+  while (true) {
+    while (l < r && left(A[l]))
+      ++l;
+    while (l < r && right(A[r - 1]))
+      --r;
+    if (r - l <= 1)
+      return l;
+    std::swap(A[l++], A[--r]);
+  }
+}
+
+// 切分策略: hoare逐个比较交换, block为上面的分块切分
+enum class Partition { hoare, block };
+
+template <typename compar, Partition P = Partition::hoare>
+  requires std::totally_ordered<compar>
+struct Quick226 {
+  static void sort(ns::vector<compar> &A) {
+    std::ranges::shuffle(A, std::mt19937(std::random_device{}()));
+    sort(A, 0, A.size() - 1);
+  }
+  static void sort(ns::vector<compar> &A, int lo, int hi) {
+    if (lo >= hi)
+      return;
+    int p{P == Partition::block ? partitionBlock(A, lo, hi)
+                                : partition113(A, lo, hi)};
+    sort(A, lo, p - 1);
+    sort(A, p + 1, hi);
+  }
+
+  // 等于枢轴的元素两边都算放错, 和partition226一样在重复元素上对半分
+  static int partitionBlock(ns::vector<compar> &A, int lo, int hi) {
+    compar pivot{A[lo]};
+    int k{blockPartition(
+        A, lo + 1, hi, [&](const compar &x) { return x < pivot; },
+        [&](const compar &x) { return pivot < x; })};
+    std::swap(A[lo], A[k - 1]);
+    return k - 1;
+  }
+
+  static int partition226(ns::vector<compar> &A, int lo, int hi) {
+    int i{lo}, j{hi + 1};
+    while (true) {
+      while (A[--j] > A[lo])
+        if (j == lo)
+          break;
+      while (A[++i] < A[lo])
+        if (i == hi)
+          break;
+      if (i >= j)
+        break;
+      std::swap(A[i], A[j]);
+    }
+    assert(i == j || i - j == 1);
+    std::swap(A[lo], A[j]);
+    return j;
+  }
+
+  static int partition113(ns::vector<compar> &A, int lo, int hi) {
+    int i{lo}, j{hi + 1};
+    while (true) {
+      do
+        i++;
+      while (A[i] < A[lo] && i < hi);
+      do
+        j--;
+      while (A[j] > A[lo] && j > lo);
+      if (i >= j)
+        break;
+      std::swap(A[i], A[j]);
+    }
+    assert(i == j || i - j == 1);
+    std::swap(A[lo], A[j]);
+    return j;
+  }
+};
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct Quick408 {
+  static void sort(ns::vector<compar> &A) {
+    std::ranges::shuffle(A, std::mt19937(std::random_device{}()));
+    sort(A, 0, A.size() - 1);
+  }
+  static void sort(ns::vector<compar> &A, int lo, int hi) {
+    if (lo >= hi)
+      return;
+    int p{partition912(A, lo, hi)};
+    sort(A, lo, p - 1);
+    sort(A, p + 1, hi);
+  }
+
+  static int partition408(ns::vector<compar> &A, int lo, int hi) {
+    compar pivot{A[lo]};
+    do {
+      while (lo < hi && A[hi] >= pivot)
+        --hi;
+      A[lo] = A[hi];
+      while (lo < hi && A[lo] <= pivot)
+        ++lo;
+      A[hi] = A[lo];
+    } while (lo < hi);
+    assert(lo == hi);
+    A[lo] = pivot;
+    return lo;
+  }
+
+  static int partition660(ns::vector<compar> &A, int lo, int hi) {
+    compar pivot{A[lo]};
+    do {
+      while (lo < hi && A[hi] > pivot)
+        --hi;
+      if (lo < hi)
+        A[lo++] = A[hi];
+      while (lo < hi && A[lo] < pivot)
+        ++lo;
+      if (lo < hi)
+        A[hi--] = A[lo];
+    } while (lo < hi);
+    assert(lo == hi);
+    A[lo] = pivot;
+    return lo;
+  }
+
+  static int partition912(ns::vector<compar> &A, int lo, int hi) {
+    compar pivot{A[lo]};
+    do {
+      while (lo < hi)
+        if (A[hi] > pivot)
+          --hi;
+        else {
+          A[lo++] = A[hi];
+          break;
+        }
+      while (lo < hi)
+        if (A[lo] < pivot)
+          ++lo;
+        else {
+          A[hi--] = A[lo];
+          break;
+        }
+    } while (lo < hi);
+    assert(lo == hi);
+    A[lo] = pivot;
+    return lo;
+  }
+};
+
+template <typename compar, Partition P = Partition::hoare>
+  requires std::totally_ordered<compar>
+struct Quick3way {
+  static void sort(ns::vector<compar> &A) {
+    std::ranges::shuffle(A, std::mt19937(std::random_device{}()));
+    sort(A, 0, A.size() - 1);
+  }
+  static void sort(ns::vector<compar> &A, int lo, int hi) {
+    if (lo >= hi)
+      return;
+    auto [lt, gt]{partition(A, lo, hi)};
+    sort(A, lo, lt - 1);
+    sort(A, gt + 1, hi);
+  }
+
+  // 以A[lo]为枢轴三向切分, 返回等于枢轴的区间[lt, gt]
+  static std::pair<int, int> partition(ns::vector<compar> &A, int lo, int hi) {
+    compar pivot{A[lo]};
+    if constexpr (P == Partition::block) {
+      // 两遍分块切分: 先分出小于枢轴的, 再从其余中分出等于枢轴的
+      auto less = [&](const compar &x) { return x < pivot; };
+      auto greater = [&](const compar &x) { return pivot < x; };
+      int lt{blockPartition(A, lo + 1, hi, less, std::not_fn(less))};
+      int gt{blockPartition(A, lt, hi, std::not_fn(greater), greater)};
+      std::swap(A[lo], A[lt - 1]);
+      return {lt - 1, gt - 1};
+    }
+    int lt{lo}, gt{hi};
+    int i{lo + 1};
+    while (i <= gt) {
+      if (A[i] < pivot)
+        std::swap(A[lt++], A[i++]);
+      else if (A[i] > pivot)
+        std::swap(A[i], A[gt--]);
+      else if (A[i] == pivot)
+        ++i;
+    }
+    return {lt, gt};
+  }
+};
+
+/**
+ * 内省排序, 在Quick3way上加:
+ *   三数/九数取中代替整体洗牌, 小区间插入排序, 递归过深改用堆排序,
+ *   不小于grain的子区间交给线程池, 空闲线程窃取执行
+ */
+template <typename compar, Partition P = Partition::hoare>
+  requires std::totally_ordered<compar>
+struct IntroSort {
+  static constexpr int cutoff{24}, ninther{128}, grain{1 << 15};
+  struct Range {
+    int lo, hi, depth;
+  };
+
+  static void sort(ns::vector<compar> &A,
+                   ThreadPool &pool = ThreadPool::global()) {
+    sort(A, 0, A.size() - 1, pool);
+  }
+  // 只排A[lo, hi]
+  static void sort(ns::vector<compar> &A, int lo, int hi, ThreadPool &pool) {
+    int n{std::max(hi - lo + 1, 0)};
+    Range root{lo, hi, 2 * int(std::bit_width(unsigned(n)))};
+    if (pool.size() == 1 || n <= grain)
+      return serial(A, root);
+    pool.forkJoin(root, [&](Range r, auto &spawn) { sort(A, r, spawn); });
+  }
+  static void serial(ns::vector<compar> &A, Range r) {
+    sort(A, r, [&](Range s) { serial(A, s); });
+  }
+
+  // 较小一侧递归或分出, 较大一侧循环, 栈深O(log n)
+  template <class Spawn>
+  static void sort(ns::vector<compar> &A, Range r, Spawn &&spawn) {
+    int lo{r.lo}, hi{r.hi}, depth{r.depth};
+    while (hi - lo + 1 > cutoff) {
+      if (depth-- == 0)
+        return heap<compar>::sort(A, lo, hi);
+      std::swap(A[lo], A[pivot(A, lo, hi)]);
+      auto [lt, gt]{Quick3way<compar, P>::partition(A, lo, hi)};
+      Range small{lo, lt - 1, depth}, large{gt + 1, hi, depth};
+      if (lt - lo > hi - gt)
+        std::swap(small, large);
+      if (small.hi - small.lo + 1 >= grain)
+        spawn(small);
+      else
+        sort(A, small, spawn);
+      lo = large.lo, hi = large.hi;
+    }
+    insertion(A, lo, hi);
+  }
+
+  static int median3(ns::vector<compar> &A, int i, int j, int k) {
+    return A[i] < A[j] ? (A[j] < A[k] ? j : A[i] < A[k] ? k : i)
+                       : (A[k] < A[j] ? j : A[k] < A[i] ? k : i);
+  }
+  // 小区间三数取中, 大区间取三组三数中值的中值(Tukey ninther)
+  static int pivot(ns::vector<compar> &A, int lo, int hi) {
+    int n{hi - lo + 1}, mid{lo + n / 2};
+    if (n < ninther)
+      return median3(A, lo, mid, hi);
+    int s{n / 8};
+    return median3(A, median3(A, lo, lo + s, lo + 2 * s),
+                   median3(A, mid - s, mid, mid + s),
+                   median3(A, hi - 2 * s, hi - s, hi));
+  }
+};
@@ -1,55 +1,240 @@
+#include "ThreadPool.hh"
 #include "vector.hh"
+#include <algorithm>
+#include <cassert>
 #include <concepts>
+#include <functional>
 #include <print>
 #include <random>
+#include <string>
+#include <string_view>
 
-// least significant digit first radix sort
-template <class T>
-  requires std::integral<T>
-void LSD(ns::vector<T> &A) {
-  constexpr int BYTES = sizeof(T);
+// key(x)的类型, 默认按元素本身排序
+template <class T, class Key>
+using RadixKey = std::remove_cvref_t<std::invoke_result_t<Key &, const T &>>;
+
+/**
+ * least significant digit first radix sort, 按key(x)逐字节稳定排序
+ *   一遍读出所有字节的直方图, 某字节全部相同时跳过这一趟
+ *   多线程时每个线程数自己那一段, 偏移按(桶, 线程)排好后并行分发
+ */
+template <class T, class Key = std::identity>
+  requires std::integral<RadixKey<T, Key>>
+void LSD(ns::vector<T> &A, Key key = {},
+         ThreadPool &pool = ThreadPool::global()) {
+  using K = RadixKey<T, Key>;
+  using U = std::make_unsigned_t<K>;
+  constexpr int BYTES = sizeof(K);
   constexpr int BITS_PER_BYTE = 8;
   constexpr int R = 1 << BITS_PER_BYTE;
   constexpr int MASK = R - 1;
 
   int n = A.size();
-  ns::vector<T> aux(n);
+  if (n < 2)
+    return;
+  int threads = n < (1 << 16) ? 1 : pool.size();
+  auto digit = [&](const T &x, int d) {
+    return int(U(key(x)) >> BITS_PER_BYTE * d & MASK);
+  };
+  auto each = [&](std::function<void(int)> f) {
+    threads == 1 ? f(0) : pool.run(std::move(f));
+  };
+  auto chunk = [&](int t) {
+    return std::pair{int(long(n) * t / threads),
+                     int(long(n) * (t + 1) / threads)};
+  };
 
-  for (int d = 0; d < BYTES; d++) {
-    ns::vector<int> count(R + 1, 0);
-    for (int i = 0; i < n; i++) {
-      int c = (A[i] >> BITS_PER_BYTE * d) & MASK;
-      count[c + 1]++;
+  // count[t][d][r]: 第t段中第d个字节为r的个数
+  ns::vector<int> count(threads * BYTES * R, 0);
+  auto at = [&](int t, int d) { return &count[(t * BYTES + d) * R]; };
+  each([&](int t) {
+    auto [lo, hi] = chunk(t);
+    for (int i = lo; i < hi; i++) {
+      U k(key(A[i]));
+      for (int d = 0; d < BYTES; d++)
+        at(t, d)[k >> BITS_PER_BYTE * d & MASK]++;
     }
+  });
+
+  ns::vector<T> aux(n);
+  // 直方图还对应当前A的分段
+  bool fresh = true;
+  for (int d = 0; d < BYTES; d++) {
+    int same = 0;
+    for (int t = 0; t < threads; t++)
+      same += at(t, d)[digit(A[0], d)];
+    if (same == n)
+      continue;
+
+    if (!fresh)
+      each([&](int t) {
+        auto [lo, hi] = chunk(t);
+        int *c = at(t, d);
+        std::fill(c, c + R, 0);
+        for (int i = lo; i < hi; i++)
+          c[digit(A[i], d)]++;
+      });
 
-    for (int r = 0; r < R; r++)
-      count[r + 1] += count[r];
-
-    if constexpr (std::is_signed_v<T>) {
-      if (d == BYTES - 1) {
-        int shift1 = count[R] - count[R / 2];
-        int shift2 = count[R / 2];
-        // shift right positive integer
-        for (int r = 0; r < R / 2; r++)
-          count[r] += shift1;
-        // shift left negative integer
-        for (int r = R / 2; r < R; r++)
-          count[r] -= shift2;
+    // 有符号数最高字节128..255是负数, 排在0..127前面
+    int first = 0;
+    if constexpr (std::is_signed_v<K>)
+      if (d == BYTES - 1)
+        first = R / 2;
+    int sum = 0;
+    for (int i = 0; i < R; i++)
+      for (int t = 0, r = (first + i) & MASK; t < threads; t++) {
+        int c = at(t, d)[r];
+        at(t, d)[r] = sum;
+        sum += c;
       }
-    }
 
-    for (int i = 0; i < n; i++) {
-      int c = (A[i] >> BITS_PER_BYTE * d) & MASK;
-      aux[count[c]++] = A[i];
-    }
+    each([&](int t) {
+      auto [lo, hi] = chunk(t);
+      int *next = at(t, d);
+      for (int i = lo; i < hi; i++)
+        aux[next[digit(A[i], d)]++] = A[i];
+    });
     std::swap(A, aux);
+    // 单线程时各字节的总数不随顺序改变, 直方图仍可用
+    fresh = threads == 1;
+  }
+}
+
+/**
+ * most significant digit first radix sort, 键为整数或字符串
+ *   从最高字节起分桶, 桶内再按下一字节递归, 长键只看到能区分顺序为止
+ *   字符串结尾记为数字0, 其余字符加1; 小区间插入排序
+ */
+constexpr int MSD_R = 257, MSD_CUTOFF = 16;
+
+template <class K> int msdDigit(const K &k, int d) {
+  if constexpr (std::integral<K>) {
+    using U = std::make_unsigned_t<K>;
+    U u(k);
+    if constexpr (std::is_signed_v<K>)
+      u ^= U(1) << (8 * sizeof(K) - 1);
+    return int(u >> 8 * (sizeof(K) - 1 - d) & 0xff) + 1;
+  } else {
+    std::string_view s(k);
+    return d < s.size() ? (unsigned char)s[d] + 1 : 0;
+  }
+}
 
-    std::print("\n");
-    std::ranges::for_each(A, [](auto x) { std::print("{}\t", x); });
-    std::print("\n");
+// 按第d个数字把A[lo, hi)稳定分桶, end[r]为桶r的结尾, 只有一个桶时不搬动
+template <class T, class Key>
+bool msdDistribute(ns::vector<T> &A, ns::vector<T> &aux, int lo, int hi,
+                   int d, Key &key, int (&end)[MSD_R]) {
+  int count[MSD_R + 1]{};
+  for (int i = lo; i < hi; i++)
+    count[msdDigit(key(A[i]), d) + 1]++;
+  for (int r = 0; r < MSD_R; r++) {
+    if (count[r + 1] == hi - lo) {
+      std::fill(end, end + r, lo);
+      std::fill(end + r, end + MSD_R, hi);
+      return false;
+    }
+    count[r + 1] += count[r];
   }
+  for (int i = lo; i < hi; i++)
+    aux[lo + count[msdDigit(key(A[i]), d)]++] = A[i];
+  std::copy(&aux[lo], &aux[0] + hi, &A[lo]);
+  for (int r = 0; r < MSD_R; r++)
+    end[r] = lo + count[r];
+  return true;
 }
 
+// 显式栈代替递归, 共同前缀再长也不会栈溢出
+// 区间内所有键落在同一个桶时原地换下一个数字, 真正分开后各桶才入栈
+template <class T, class Key>
+void msd(ns::vector<T> &A, ns::vector<T> &aux, int lo, int hi, int d,
+         Key &key) {
+  using K = RadixKey<T, Key>;
+  struct Range {
+    int lo, hi, d;
+  };
+  ns::vector<Range> todo;
+  todo.push_back(Range{lo, hi, d});
+  while (!todo.empty()) {
+    auto [lo, hi, d] = todo.back();
+    todo.pop_back();
+    if (hi - lo <= MSD_CUTOFF) {
+      for (int i = lo + 1; i < hi; i++)
+        for (int j = i; j > lo && key(A[j]) < key(A[j - 1]); j--)
+          std::swap(A[j], A[j - 1]);
+      continue;
+    }
+    int end[MSD_R];
+    bool split{false};
+    for (; !(std::integral<K> && d == int(sizeof(K))); d++)
+      // 整个区间都是已经结束的字符串时全部相等
+      if ((split = msdDistribute(A, aux, lo, hi, d, key, end)) ||
+          end[0] == hi)
+        break;
+    if (!split)
+      continue;
+    // 桶0是已经结束的字符串
+    for (int r = 1; r < MSD_R; r++)
+      if (end[r] - end[r - 1] > 1)
+        todo.push_back(Range{end[r - 1], end[r], d + 1});
+  }
+}
+
+// 最高几位相同的部分串行跳过, 第一次真正分开后各桶交给线程池
+template <class T, class Key = std::identity>
+  requires std::integral<RadixKey<T, Key>> ||
+           std::convertible_to<RadixKey<T, Key>, std::string_view>
+void MSD(ns::vector<T> &A, Key key = {},
+         ThreadPool &pool = ThreadPool::global()) {
+  using K = RadixKey<T, Key>;
+  int n = A.size();
+  if (n < 2)
+    return;
+  ns::vector<T> aux(n);
+  if (pool.size() == 1 || n < (1 << 16))
+    return msd(A, aux, 0, n, 0, key);
+  int d = 0, end[MSD_R];
+  for (; !msdDistribute(A, aux, 0, n, d, key, end); d++)
+    if (end[0] == n || (std::integral<K> && d + 1 == sizeof(K)))
+      return;
+  pool.parallelFor(MSD_R - 1, 1, [&](long lo, long hi, int) {
+    for (long r = lo + 1; r <= hi; r++)
+      if (end[r] - end[r - 1] > 1)
+        msd(A, aux, end[r - 1], end[r], d + 1, key);
+  });
+}
+
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  ThreadPool serial(1);
+  bench.sort("LSD", [](auto &A) { LSD(A); });
+  bench.sort("LSD<serial>",
+             [&](auto &A) { LSD(A, std::identity{}, serial); });
+  bench.sort("MSD", [](auto &A) { MSD(A); });
+  bench.sort("MSD<serial>",
+             [&](auto &A) { MSD(A, std::identity{}, serial); });
+  bench.bulk(
+      "sort", "MSD<string>",
+      [&](int n, Dist d) {
+        auto A{benchData(d, n, bench.seed)};
+        ns::vector<std::string> S(n);
+        for (int i = 0; i < n; i++)
+          S[i] = std::to_string(A[i]);
+        return S;
+      },
+      [](ns::vector<std::string> &S) { MSD(S); },
+      [](ns::vector<std::string> &S) {
+        return std::is_sorted(S.begin(), S.end());
+      });
+}
+#else
+struct Record {
+  long long key;
+  int value;
+};
+
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution<int> rand(0x80000000, 0x7fffffff);
@@ -67,4 +252,68 @@ int main() {
   std::print("\n\n");
   std::print("{}", std::ranges::is_sorted(A) ? "Sorted" : "Unsorted");
   std::print("\n");
-}
\ No newline at end of file
+
+  // 与std::sort比对, 4线程, 也覆盖高位字节全相同的情况
+  ThreadPool pool(4);
+  auto check = [&]<class T>(ns::vector<T> B) {
+    ns::vector<T> want(B), C(B);
+    std::sort(want.begin(), want.end());
+    LSD(B, std::identity{}, pool);
+    MSD(C, std::identity{}, pool);
+    assert(std::equal(B.begin(), B.end(), want.begin(), want.end()));
+    assert(std::equal(C.begin(), C.end(), want.begin(), want.end()));
+  };
+  for (int n : {0, 1, 17, 1000, 1 << 17}) {
+    ns::vector<int> I(n), small(n);
+    ns::vector<unsigned> U(n);
+    ns::vector<long long> L(n);
+    ns::vector<signed char> C(n);
+    for (int i = 0; i < n; i++) {
+      I[i] = rand(mt), small[i] = rand(mt) % 1000, U[i] = mt();
+      L[i] = (long long)(mt()) << 32 | mt(), C[i] = mt();
+    }
+    check(I), check(small), check(U), check(L), check(C);
+  }
+
+  // 键值对按键稳定排序
+  ns::vector<Record> records(1 << 17);
+  for (int i = 0; i < records.size(); i++)
+    records[i] = {rand(mt) % 100 - 50, i};
+  ns::vector<Record> byLSD(records), byMSD(records);
+  auto key = [](const Record &r) { return r.key; };
+  auto stable = [](const Record &a, const Record &b) {
+    return a.key < b.key || (a.key == b.key && a.value < b.value);
+  };
+  LSD(byLSD, key, pool);
+  MSD(byMSD, key, pool);
+  assert(std::is_sorted(byLSD.begin(), byLSD.end(), stable));
+  assert(std::is_sorted(byMSD.begin(), byMSD.end(), stable));
+
+  // 字符串, 含空串与公共前缀
+  ns::vector<std::string> S(1 << 17);
+  for (auto &s : S) {
+    s = std::string(mt() % 4, 'a');
+    for (int k = mt() % 8; k > 0; k--)
+      s += char('a' + mt() % 3);
+  }
+  ns::vector<std::string> want(S);
+  std::sort(want.begin(), want.end());
+  MSD(S, std::identity{}, pool);
+  assert(std::equal(S.begin(), S.end(), want.begin(), want.end()));
+
+  // 很长的公共前缀, 以及每层只分出一个已结束串的阶梯, 都不能按深度递归
+  ThreadPool serial(1);
+  std::string prefix(20000, 'x');
+  ns::vector<std::string> P(100), stairs(3000);
+  for (int i = 0; i < P.size(); i++)
+    P[i] = prefix + std::to_string(mt() % 1000);
+  for (int i = 0; i < stairs.size(); i++)
+    stairs[i] = std::string(stairs.size() - i, 'y');
+  for (auto *T : {&P, &stairs}) {
+    ns::vector<std::string> want(*T);
+    std::sort(want.begin(), want.end());
+    MSD(*T, std::identity{}, serial);
+    assert(std::equal(T->begin(), T->end(), want.begin(), want.end()));
+  }
+}
+#endif
@@ -0,0 +1,90 @@
+#include "SortSIMD.hh"
+#include <print>
+#include <random>
+
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.sort("std::sort", [](auto &A) { std::sort(A.begin(), A.end()); });
+  bench.sort("IntroSort<block>",
+             [](auto &A) { IntroSort<int, Partition::block>::sort(A); });
+  bench.sort("SimdSort", [](auto &A) { SimdSort<int>::sort(A); });
+  ThreadPool serial(1);
+  bench.sort("SimdSort<serial>",
+             [&](auto &A) { SimdSort<int>::sort(A, serial); });
+  bench.sort("SimdSort<float>", [](auto &A) {
+    ns::vector<float> F(A.size());
+    std::copy(A.begin(), A.end(), F.begin());
+    SimdSort<float>::sort(F);
+    std::copy(F.begin(), F.end(), A.begin());
+  });
+}
+#else
+// 与std::sort比对
+template <class T> void check(ns::vector<T> A) {
+  ns::vector<T> want(A);
+  std::sort(want.begin(), want.end());
+  SimdSort<T>::sort(A);
+  assert(std::equal(A.begin(), A.end(), want.begin(), want.end()));
+}
+
+// 随机, 有序, 逆序, 大量重复, 全部相同
+template <class T> void checkShapes(int n, std::mt19937_64 &mt) {
+  ns::vector<T> A(n);
+  for (int shape = 0; shape < 5; ++shape) {
+    for (int i = 0; i < n; ++i) {
+      auto x{mt()};
+      if constexpr (std::floating_point<T>)
+        A[i] = shape == 0   ? T(std::int64_t(x)) / T(1 << 20)
+               : shape == 1 ? T(i)
+               : shape == 2 ? T(n - i)
+               : shape == 3 ? T(x % 16) - 8
+                            : T(1.5);
+      else
+        A[i] = shape == 0   ? T(x)
+               : shape == 1 ? T(i)
+               : shape == 2 ? T(n - i)
+               : shape == 3 ? T(x % 16 - 8)
+                            : T(7);
+    }
+    check(A);
+  }
+}
+
+template <class T> void checkAll(std::mt19937_64 &mt) {
+  for (int n = 0; n <= 300; ++n)
+    checkShapes<T>(n, mt);
+  for (int n : {1000, 4099, 1 << 16, 1 << 20})
+    checkShapes<T>(n, mt);
+}
+
+int main() {
+  std::mt19937 mt(std::random_device{}());
+  std::uniform_int_distribution rand(10, 99);
+  ns::vector<int> A(16);
+  for (auto &e : A) {
+    e = rand(mt);
+    std::print("{}\t", e);
+  }
+  std::print("\n\n");
+  SimdSort<int>::sort(A);
+  std::ranges::for_each(A, [](auto x) { std::print("{}\t", x); });
+  std::print("\n");
+  std::print("{}", std::ranges::is_sorted(A) ? "Sorted" : "Unsorted");
+  std::print("\n\n");
+
+  std::mt19937_64 mt64(mt());
+  checkAll<int>(mt64);
+  checkAll<unsigned>(mt64);
+  checkAll<long>(mt64);
+  checkAll<unsigned long long>(mt64);
+  checkAll<float>(mt64);
+  checkAll<double>(mt64);
+  // 不支持SIMD的类型退回IntroSort
+  checkAll<short>(mt64);
+  std::print("SIMD: int {}, double {}\n", Simd<int>::enabled,
+             Simd<double>::enabled);
+}
+#endif
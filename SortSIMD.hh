@@ -0,0 +1,519 @@
+#pragma once
+#include "SortQuick.hh"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <limits>
+#if defined(__AVX2__)
+// GCC 12的AVX-512头文件用自身初始化的占位值, 内联后误报未初始化
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+#endif
+
+/**
+ * 32/64位整数与浮点数的SIMD排序
+ *   切分: 一次比较N道, 按掩码把小于枢轴的道压到前面, 整个向量写到两端
+ *   小区间: 寄存器内双调排序网络, 再在寄存器之间双调合并
+ * 有AVX-512用16/8道, 只有AVX2用8/4道, 都没有或类型不支持时退回IntroSort
+ */
+
+// 一个寄存器N道T, enabled为false时该类型不走SIMD
+template <class T> struct Simd {
+  static constexpr bool enabled{false};
+};
+
+#if defined(__AVX512F__)
+template <class T>
+  requires(std::signed_integral<T> && sizeof(T) == 4)
+struct Simd<T> {
+  static constexpr bool enabled{true};
+  static constexpr int N{16};
+  using V = __m512i;
+  static V load(const T *p) { return _mm512_loadu_si512(p); }
+  static void store(T *p, V v) { _mm512_storeu_si512(p, v); }
+  static V set1(T x) { return _mm512_set1_epi32(x); }
+  static V min(V a, V b) { return _mm512_min_epi32(a, b); }
+  static V max(V a, V b) { return _mm512_max_epi32(a, b); }
+  static unsigned less(V v, V p) { return _mm512_cmplt_epi32_mask(v, p); }
+  static unsigned lessEq(V v, V p) { return _mm512_cmple_epi32_mask(v, p); }
+  static V perm(V v, const int *idx) {
+    return _mm512_permutexvar_epi32(_mm512_loadu_si512(idx), v);
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm512_mask_blend_epi32(m, a, b);
+  }
+  static V compress(V v, unsigned m) {
+    return _mm512_mask_expand_epi32(_mm512_maskz_compress_epi32(m, v),
+                                    ~0u << std::popcount(m),
+                                    _mm512_maskz_compress_epi32(~m, v));
+  }
+};
+
+template <> struct Simd<float> {
+  static constexpr bool enabled{true};
+  static constexpr int N{16};
+  using V = __m512;
+  static V load(const float *p) { return _mm512_loadu_ps(p); }
+  static void store(float *p, V v) { _mm512_storeu_ps(p, v); }
+  static V set1(float x) { return _mm512_set1_ps(x); }
+  static V min(V a, V b) { return _mm512_min_ps(a, b); }
+  static V max(V a, V b) { return _mm512_max_ps(a, b); }
+  static unsigned less(V v, V p) {
+    return _mm512_cmp_ps_mask(v, p, _CMP_LT_OQ);
+  }
+  static unsigned lessEq(V v, V p) {
+    return _mm512_cmp_ps_mask(v, p, _CMP_LE_OQ);
+  }
+  static V perm(V v, const int *idx) {
+    return _mm512_permutexvar_ps(_mm512_loadu_si512(idx), v);
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm512_mask_blend_ps(m, a, b);
+  }
+  static V compress(V v, unsigned m) {
+    return _mm512_mask_expand_ps(_mm512_maskz_compress_ps(m, v),
+                                 ~0u << std::popcount(m),
+                                 _mm512_maskz_compress_ps(~m, v));
+  }
+};
+
+template <class T>
+  requires(std::signed_integral<T> && sizeof(T) == 8)
+struct Simd<T> {
+  static constexpr bool enabled{true};
+  static constexpr int N{8};
+  using V = __m512i;
+  static V load(const T *p) { return _mm512_loadu_si512(p); }
+  static void store(T *p, V v) { _mm512_storeu_si512(p, v); }
+  static V set1(T x) { return _mm512_set1_epi64(x); }
+  static V min(V a, V b) { return _mm512_min_epi64(a, b); }
+  static V max(V a, V b) { return _mm512_max_epi64(a, b); }
+  static unsigned less(V v, V p) { return _mm512_cmplt_epi64_mask(v, p); }
+  static unsigned lessEq(V v, V p) { return _mm512_cmple_epi64_mask(v, p); }
+  static V perm(V v, const int *idx) {
+    __m512i i{_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)idx))};
+    return _mm512_permutexvar_epi64(i, v);
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm512_mask_blend_epi64(m, a, b);
+  }
+  static V compress(V v, unsigned m) {
+    return _mm512_mask_expand_epi64(_mm512_maskz_compress_epi64(m, v),
+                                    ~0u << std::popcount(m),
+                                    _mm512_maskz_compress_epi64(~m, v));
+  }
+};
+
+template <> struct Simd<double> {
+  static constexpr bool enabled{true};
+  static constexpr int N{8};
+  using V = __m512d;
+  static V load(const double *p) { return _mm512_loadu_pd(p); }
+  static void store(double *p, V v) { _mm512_storeu_pd(p, v); }
+  static V set1(double x) { return _mm512_set1_pd(x); }
+  static V min(V a, V b) { return _mm512_min_pd(a, b); }
+  static V max(V a, V b) { return _mm512_max_pd(a, b); }
+  static unsigned less(V v, V p) {
+    return _mm512_cmp_pd_mask(v, p, _CMP_LT_OQ);
+  }
+  static unsigned lessEq(V v, V p) {
+    return _mm512_cmp_pd_mask(v, p, _CMP_LE_OQ);
+  }
+  static V perm(V v, const int *idx) {
+    __m512i i{_mm512_cvtepi32_epi64(_mm256_loadu_si256((const __m256i *)idx))};
+    return _mm512_permutexvar_pd(i, v);
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm512_mask_blend_pd(m, a, b);
+  }
+  static V compress(V v, unsigned m) {
+    return _mm512_mask_expand_pd(_mm512_maskz_compress_pd(m, v),
+                                 ~0u << std::popcount(m),
+                                 _mm512_maskz_compress_pd(~m, v));
+  }
+};
+#elif defined(__AVX2__)
+// AVX2只有32位道的任意置换, 64位的道拆成两个32位道
+inline __m256i laneIdx32(const int *idx) {
+  return _mm256_loadu_si256((const __m256i *)idx);
+}
+inline __m256i laneIdx64(const int *idx) {
+  return _mm256_setr_epi32(2 * idx[0], 2 * idx[0] + 1, 2 * idx[1],
+                           2 * idx[1] + 1, 2 * idx[2], 2 * idx[2] + 1,
+                           2 * idx[3], 2 * idx[3] + 1);
+}
+
+// 掩码第i位为1的道全1
+inline __m256i laneMask32(unsigned m) {
+  __m256i bits{_mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128)};
+  return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(m), bits),
+                            bits);
+}
+inline __m256i laneMask64(unsigned m) {
+  __m256i bits{_mm256_setr_epi64x(1, 2, 4, 8)};
+  return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(m), bits),
+                            bits);
+}
+
+// 压缩表: 把掩码m中的道依次移到前面, 其余道随后, 每个32位下标占4位
+template <int N> constexpr std::array<std::uint32_t, 1 << N> compressTable() {
+  std::array<std::uint32_t, 1 << N> t{};
+  constexpr int W{8 / N};
+  for (unsigned m = 0; m < (1u << N); ++m)
+    for (int pass = 0, k = 0; pass < 2; ++pass)
+      for (int i = 0; i < N; ++i)
+        if (bool(m >> i & 1) == (pass == 0))
+          for (int w = 0; w < W; ++w, ++k)
+            t[m] |= std::uint32_t(i * W + w) << 4 * k;
+  return t;
+}
+
+template <int N> __m256i compressIdx(unsigned m) {
+  static constexpr auto table{compressTable<N>()};
+  __m256i shift{_mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28)};
+  return _mm256_and_si256(
+      _mm256_srlv_epi32(_mm256_set1_epi32(table[m]), shift),
+      _mm256_set1_epi32(7));
+}
+
+template <class T>
+  requires(std::signed_integral<T> && sizeof(T) == 4)
+struct Simd<T> {
+  static constexpr bool enabled{true};
+  static constexpr int N{8};
+  using V = __m256i;
+  static V load(const T *p) { return _mm256_loadu_si256((const V *)p); }
+  static void store(T *p, V v) { _mm256_storeu_si256((V *)p, v); }
+  static V set1(T x) { return _mm256_set1_epi32(x); }
+  static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+  static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+  static unsigned less(V v, V p) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(p, v)));
+  }
+  static unsigned lessEq(V v, V p) { return ~less(p, v) & 0xff; }
+  static V perm(V v, const int *idx) {
+    return _mm256_permutevar8x32_epi32(v, laneIdx32(idx));
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm256_blendv_epi8(a, b, laneMask32(m));
+  }
+  static V compress(V v, unsigned m) {
+    return _mm256_permutevar8x32_epi32(v, compressIdx<8>(m));
+  }
+};
+
+template <> struct Simd<float> {
+  static constexpr bool enabled{true};
+  static constexpr int N{8};
+  using V = __m256;
+  static V load(const float *p) { return _mm256_loadu_ps(p); }
+  static void store(float *p, V v) { _mm256_storeu_ps(p, v); }
+  static V set1(float x) { return _mm256_set1_ps(x); }
+  static V min(V a, V b) { return _mm256_min_ps(a, b); }
+  static V max(V a, V b) { return _mm256_max_ps(a, b); }
+  static unsigned less(V v, V p) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_LT_OQ));
+  }
+  static unsigned lessEq(V v, V p) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(v, p, _CMP_LE_OQ));
+  }
+  static V perm(V v, const int *idx) {
+    return _mm256_permutevar8x32_ps(v, laneIdx32(idx));
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(laneMask32(m)));
+  }
+  static V compress(V v, unsigned m) {
+    return _mm256_permutevar8x32_ps(v, compressIdx<8>(m));
+  }
+};
+
+// AVX2没有64位的min/max, 用比较加混合
+template <class T>
+  requires(std::signed_integral<T> && sizeof(T) == 8)
+struct Simd<T> {
+  static constexpr bool enabled{true};
+  static constexpr int N{4};
+  using V = __m256i;
+  static V load(const T *p) { return _mm256_loadu_si256((const V *)p); }
+  static void store(T *p, V v) { _mm256_storeu_si256((V *)p, v); }
+  static V set1(T x) { return _mm256_set1_epi64x(x); }
+  static V min(V a, V b) {
+    return _mm256_blendv_epi8(a, b, _mm256_cmpgt_epi64(a, b));
+  }
+  static V max(V a, V b) {
+    return _mm256_blendv_epi8(b, a, _mm256_cmpgt_epi64(a, b));
+  }
+  static unsigned less(V v, V p) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(p, v)));
+  }
+  static unsigned lessEq(V v, V p) { return ~less(p, v) & 0xf; }
+  static V perm(V v, const int *idx) {
+    return _mm256_permutevar8x32_epi32(v, laneIdx64(idx));
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm256_blendv_epi8(a, b, laneMask64(m));
+  }
+  static V compress(V v, unsigned m) {
+    return _mm256_permutevar8x32_epi32(v, compressIdx<4>(m));
+  }
+};
+
+template <> struct Simd<double> {
+  static constexpr bool enabled{true};
+  static constexpr int N{4};
+  using V = __m256d;
+  static V load(const double *p) { return _mm256_loadu_pd(p); }
+  static void store(double *p, V v) { _mm256_storeu_pd(p, v); }
+  static V set1(double x) { return _mm256_set1_pd(x); }
+  static V min(V a, V b) { return _mm256_min_pd(a, b); }
+  static V max(V a, V b) { return _mm256_max_pd(a, b); }
+  static unsigned less(V v, V p) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(v, p, _CMP_LT_OQ));
+  }
+  static unsigned lessEq(V v, V p) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(v, p, _CMP_LE_OQ));
+  }
+  static V perm(V v, const int *idx) {
+    return _mm256_castsi256_pd(
+        _mm256_permutevar8x32_epi32(_mm256_castpd_si256(v), laneIdx64(idx)));
+  }
+  static V select(V a, V b, unsigned m) {
+    return _mm256_blendv_pd(a, b, _mm256_castsi256_pd(laneMask64(m)));
+  }
+  static V compress(V v, unsigned m) {
+    return _mm256_castsi256_pd(_mm256_permutevar8x32_epi32(
+        _mm256_castpd_si256(v), compressIdx<4>(m)));
+  }
+};
+#endif
+
+template <class T>
+  requires Simd<T>::enabled
+struct SimdKernel {
+  using S = Simd<T>;
+  using V = typename S::V;
+  // 不超过cutoff的区间用R个寄存器的排序网络
+  static constexpr int N{S::N}, R{8}, cutoff{R * N}, grain{1 << 15};
+  struct Range {
+    int lo, hi, depth;
+  };
+
+  /**
+   * 寄存器内双调排序第k级距离j的一步, 第i道与第i^j道比较交换
+   * k = 2N时整个寄存器升序, 用于整理双调序列; 置换下标和掩码都是编译期常量
+   */
+  template <int k, int j> static V step(V v) {
+    static constexpr auto idx{[] {
+      std::array<int, N> idx{};
+      for (int i = 0; i < N; ++i)
+        idx[i] = i ^ j;
+      return idx;
+    }()};
+    constexpr unsigned up{[] {
+      unsigned m{0};
+      for (int i = 0; i < N; ++i)
+        m |= unsigned(bool(i & j) == !(i & k)) << i;
+      return m;
+    }()};
+    V p{S::perm(v, idx.data())};
+    return S::select(S::min(v, p), S::max(v, p), up);
+  }
+  // 单个寄存器的双调排序
+  template <int k = 2, int j = 1> static V sortVec(V v) {
+    if constexpr (k > N)
+      return v;
+    else if constexpr (j > 1)
+      return sortVec<k, j / 2>(step<k, j>(v));
+    else
+      return sortVec<2 * k, k>(step<k, j>(v));
+  }
+  // 寄存器内是双调序列时整理成升序
+  template <int j = N / 2> static V cleanup(V v) {
+    if constexpr (j > 1)
+      return cleanup<j / 2>(step<2 * N, j>(v));
+    else
+      return step<2 * N, j>(v);
+  }
+  static V reverse(V v) {
+    static constexpr auto idx{[] {
+      std::array<int, N> idx{};
+      for (int i = 0; i < N; ++i)
+        idx[i] = N - 1 - i;
+      return idx;
+    }()};
+    return S::perm(v, idx.data());
+  }
+
+  // r个寄存器先各自排序, 再两两双调合并成更长的有序段
+  template <int r> static void sortRegs(V *v) {
+    for (int i = 0; i < r; ++i)
+      v[i] = sortVec(v[i]);
+    for (int w = 1; w < r; w *= 2)
+      for (int b = 0; b < r; b += 2 * w) {
+        // 后半段逆序, 与前半段拼成双调序列
+        for (int i = 0; i < w / 2; ++i)
+          std::swap(v[b + w + i], v[b + 2 * w - 1 - i]);
+        for (int i = b + w; i < b + 2 * w; ++i)
+          v[i] = reverse(v[i]);
+        for (int d = w; d > 0; d /= 2)
+          for (int i = b; i < b + 2 * w; ++i)
+            if (!((i - b) & d)) {
+              V lo{S::min(v[i], v[i + d])};
+              v[i + d] = S::max(v[i], v[i + d]);
+              v[i] = lo;
+            }
+        for (int i = b; i < b + 2 * w; ++i)
+          v[i] = cleanup(v[i]);
+      }
+  }
+
+  // n <= cutoff, 不足的道用最大值填充
+  static void sortSmall(T *a, int n) {
+    if (n < 2)
+      return;
+    alignas(64) T buf[cutoff];
+    V v[R];
+    int r{1};
+    while (r * N < n)
+      r *= 2;
+    std::copy(a, a + n, buf);
+    std::fill(buf + n, buf + r * N,
+              std::numeric_limits<T>::has_infinity
+                  ? std::numeric_limits<T>::infinity()
+                  : std::numeric_limits<T>::max());
+    for (int i = 0; i < r; ++i)
+      v[i] = S::load(buf + i * N);
+    if (r == 1)
+      sortRegs<1>(v);
+    else if (r == 2)
+      sortRegs<2>(v);
+    else if (r == 4)
+      sortRegs<4>(v);
+    else
+      sortRegs<R>(v);
+    for (int i = 0; i < r; ++i)
+      S::store(buf + i * N, v[i]);
+    std::copy(buf, buf + n, a);
+  }
+
+  /**
+   * 把小于pivot(orEqual时不大于)的元素移到前面, 返回其个数, n >= 3N
+   * 先存下首尾两个向量腾出空位, 每读入一个向量就按掩码压缩后整个写到左右两端,
+   * 从空位较少的一端读, 保证两端各有至少N个空位
+   */
+  template <bool orEqual> static int partition(T *a, int n, T pivot) {
+    V p{S::set1(pivot)};
+    auto pred = [&](V v) { return orEqual ? S::lessEq(v, p) : S::less(v, p); };
+    V first{S::load(a)}, last{S::load(a + n - N)};
+    int l{N}, r{n - N}, wl{0}, wr{n};
+    while (r - l >= N) {
+      V v;
+      if (l - wl <= wr - r)
+        v = S::load(a + l), l += N;
+      else
+        r -= N, v = S::load(a + r);
+      unsigned m{pred(v)};
+      int c{std::popcount(m)};
+      V w{S::compress(v, m)};
+      S::store(a + wl, w);
+      S::store(a + wr - N, w);
+      wl += c, wr -= N - c;
+    }
+    // 剩下不足一个向量和首尾两个向量, 逐个放
+    T rest[3 * N];
+    S::store(rest, first);
+    S::store(rest + N, last);
+    std::copy(a + l, a + r, rest + 2 * N);
+    for (int i = 0, k = 2 * N + r - l; i < k; ++i)
+      if (orEqual ? !(pivot < rest[i]) : rest[i] < pivot)
+        a[wl++] = rest[i];
+      else
+        a[--wr] = rest[i];
+    return wl;
+  }
+
+  static T median3(T a, T b, T c) {
+    return a < b ? (b < c ? b : a < c ? c : a) : (c < b ? b : c < a ? c : a);
+  }
+  static T pivot(const T *a, int n) {
+    int mid{n / 2}, s{n / 8};
+    return median3(median3(a[0], a[s], a[2 * s]),
+                   median3(a[mid - s], a[mid], a[mid + s]),
+                   median3(a[n - 1 - 2 * s], a[n - 1 - s], a[n - 1]));
+  }
+
+  static void sort(T *a, int n, ThreadPool &pool) {
+    Range root{0, n, 2 * int(std::bit_width(unsigned(n)))};
+    if (pool.size() == 1 || n <= grain)
+      return serial(a, root);
+    pool.forkJoin(root, [&](Range r, auto &spawn) { sort(a, r, spawn); });
+  }
+  static void serial(T *a, Range r) {
+    sort(a, r, [&](Range s) { serial(a, s); });
+  }
+
+  // 同IntroSort::sort, 区间为[lo, hi)
+  template <class Spawn> static void sort(T *a, Range r, Spawn &&spawn) {
+    int lo{r.lo}, hi{r.hi}, depth{r.depth};
+    while (hi - lo > cutoff) {
+      if (depth-- == 0)
+        return heap<T>::sort(a, lo, hi - 1);
+      T p{pivot(a + lo, hi - lo)};
+      int k{lo + partition<false>(a + lo, hi - lo, p)};
+      // 枢轴是最小值: 等于它的都移到前面, 不再参与排序
+      if (k == lo) {
+        lo += partition<true>(a + lo, hi - lo, p);
+        continue;
+      }
+      Range small{lo, k, depth}, large{k, hi, depth};
+      if (k - lo > hi - k)
+        std::swap(small, large);
+      if (small.hi - small.lo >= grain)
+        spawn(small);
+      else
+        sort(a, small, spawn);
+      lo = large.lo, hi = large.hi;
+    }
+    sortSmall(a + lo, hi - lo);
+  }
+};
+
+// 排序时用的键类型: 无符号数翻转符号位后按对应的有符号数排序
+template <class T> struct SimdKey {
+  using type = T;
+};
+template <std::unsigned_integral T>
+  requires(sizeof(T) == 4 || sizeof(T) == 8)
+struct SimdKey<T> {
+  using type = std::make_signed_t<T>;
+};
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+struct SimdSort {
+  using K = SimdKey<compar>::type;
+  static void sort(ns::vector<compar> &A,
+                   ThreadPool &pool = ThreadPool::global()) {
+    sort(A, 0, A.size() - 1, pool);
+  }
+  // 只排A[lo, hi]
+  static void sort(ns::vector<compar> &A, int lo, int hi, ThreadPool &pool) {
+    if constexpr (Simd<K>::enabled) {
+      if (hi - lo < 1)
+        return;
+      flip(A, lo, hi);
+      SimdKernel<K>::sort(reinterpret_cast<K *>(&A[lo]), hi - lo + 1, pool);
+      flip(A, lo, hi);
+    } else
+      IntroSort<compar, Partition::block>::sort(A, lo, hi, pool);
+  }
+  static void flip(ns::vector<compar> &A, int lo, int hi) {
+    if constexpr (std::unsigned_integral<compar>)
+      for (int i = lo; i <= hi; ++i)
+        A[i] ^= compar(1) << (8 * sizeof(compar) - 1);
+  }
+};
@@ -0,0 +1,127 @@
+#pragma once
+#include "vector.hh"
+#include <algorithm>
+#include <concepts>
+
+// 冒泡排序
+template <typename compar>
+  requires std::totally_ordered<compar>
+void bubble(ns::vector<compar> &A) {
+  int n = A.size();
+  bool sorted{false};
+  while (!sorted) {
+    sorted = true;
+    for (int i = 1; i < n; ++i)
+      if (A[i] < A[i - 1]) {
+        std::swap(A[i - 1], A[i]);
+        sorted = false;
+      }
+    --n;
+  }
+}
+
+// 单选择排序
+template <typename compar>
+  requires std::totally_ordered<compar>
+void selection(ns::vector<compar> &A) {
+  for (int i(0), sz(A.size()); i < sz; ++i) {
+    int min{i};
+    for (int j = i + 1; j < sz; ++j)
+      if (A[j] < A[min])
+        min = j;
+    std::swap(A[i], A[min]);
+  }
+}
+
+// 线性插入排序, 对A[lo..hi]
+template <typename compar>
+  requires std::totally_ordered<compar>
+void insertion(ns::vector<compar> &A, int lo, int hi) {
+  for (int i = lo + 1; i <= hi; ++i) {
+    compar current{A[i]};
+    int j{i};
+    for (; j > lo && current < A[j - 1]; --j)
+      A[j] = A[j - 1];
+    A[j] = current;
+  }
+}
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+void insertion(ns::vector<compar> &A) {
+  insertion(A, 0, A.size() - 1);
+}
+
+// 折半插入排序, A[first..start-1]已有序, 把A[start..last]逐个插入
+template <typename compar>
+  requires std::totally_ordered<compar>
+void leftBisectionInsertion(ns::vector<compar> &A, int first, int last,
+                            int start) {
+  for (int i = start; i <= last; ++i) {
+    compar var{A[i]};
+    int lo{first}, hi{i - 1};
+
+    while (lo <= hi) {
+      int mid{lo + (hi - lo) / 2};
+      if (var < A[mid])
+        hi = mid - 1;
+      // var >= A[mid]
+      else
+        lo = mid + 1;
+    }
+    for (int j = i; j > lo; --j)
+      A[j] = A[j - 1];
+
+    A[lo] = var;
+  }
+}
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+void leftBisectionInsertion(ns::vector<compar> &A) {
+  leftBisectionInsertion(A, 0, A.size() - 1, 1);
+}
+
+template <typename compar>
+  requires std::totally_ordered<compar>
+void rightBisectionInsertion(ns::vector<compar> &A) {
+  for (int sz(A.size()), i(sz - 1); i >= 0; --i) {
+    compar var{A[i]};
+    int lo{i + 1}, hi{sz - 1};
+
+    while (lo <= hi) {
+      int mid{lo + (hi - lo) / 2};
+      if (var <= A[mid])
+        hi = mid - 1;
+      // var > A[mid]
+      else
+        lo = mid + 1;
+    }
+    for (int j = i; j < hi; ++j)
+      A[j] = A[j + 1];
+
+    A[hi] = var;
+  }
+}
+
+// 希尔排序
+template <typename compar>
+  requires std::totally_ordered<compar>
+void shell(ns::vector<compar> &A) {
+  int sz(A.size()), h{1};
+  // 3 * h + 1 <= sz
+  while (h < sz / 3)
+    h = 3 * h + 1;
+  while (h >= 1) {
+    for (int i = h; i < sz; ++i) {
+      compar var{A[i]};
+      int j{i};
+      while (j >= h && A[j - h] > var) {
+        A[j] = A[j - h];
+        j = j - h;
+      }
+      A[j] = var;
+    }
+    h = h / 3;
+  }
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "deque.hh"
+#include "vector.hh"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// 常驻线程池, 调用线程作为0号线程参与执行
+struct ThreadPool {
+  ns::vector<std::thread> workers;
+  std::mutex mtx;
+  std::condition_variable wake, done;
+  std::function<void(int)> job;
+  int generation{0}, running{0};
+  bool stop{false};
+
+  ThreadPool(int n = std::max(1u, std::thread::hardware_concurrency())) {
+    for (int t = 1; t < n; ++t)
+      workers.push_back([this, t] { loop(t); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard lock(mtx);
+      stop = true;
+    }
+    wake.notify_all();
+    for (auto &w : workers)
+      w.join();
+  }
+
+  int size() const { return workers.size() + 1; }
+
+  void loop(int tid) {
+    int seen{0};
+    while (true) {
+      std::unique_lock lock(mtx);
+      wake.wait(lock, [&] { return stop || generation != seen; });
+      if (stop)
+        return;
+      seen = generation;
+      lock.unlock();
+      job(tid);
+      lock.lock();
+      if (--running == 0)
+        done.notify_one();
+    }
+  }
+
+  // 每个线程执行一次f(tid), 不可重入
+  void run(std::function<void(int)> f) {
+    if (workers.empty())
+      return f(0);
+    {
+      std::lock_guard lock(mtx);
+      job = std::move(f);
+      running = workers.size();
+      ++generation;
+    }
+    wake.notify_all();
+    job(0);
+    std::unique_lock lock(mtx);
+    done.wait(lock, [&] { return running == 0; });
+  }
+
+  // [0,n)按grain切块动态领取, f(lo, hi, tid)
+  template <class F> void parallelFor(long n, long grain, F &&f) {
+    if (n <= 0)
+      return;
+    grain = std::max(grain, 1L);
+    if (workers.empty() || n <= grain)
+      return f(0L, n, 0);
+    std::atomic<long> next{0};
+    run([&](int tid) {
+      for (long lo; (lo = next.fetch_add(grain)) < n;)
+        f(lo, std::min(lo + grain, n), tid);
+    });
+  }
+
+  // 工作窃取的分治, body(task, spawn), spawn(t)把子任务压入本线程队列尾
+  // 线程先取自己队列尾部(最近分出的小任务), 空了再从别人队列头部窃取大任务
+  template <class Task, class Body> void forkJoin(Task root, Body &&body) {
+    struct Queue {
+      std::mutex mtx;
+      ns::deque<Task> tasks;
+      char pad[64];
+    };
+    int n{size()};
+    ns::vector<Queue> queues(n);
+    std::atomic<long> pending{1};
+    queues[0].tasks.push_back(root);
+    run([&](int tid) {
+      auto spawn = [&](Task t) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        std::lock_guard lock(queues[tid].mtx);
+        queues[tid].tasks.push_back(t);
+      };
+      auto take = [&](Task &t) {
+        for (int k = 0; k < n; ++k) {
+          Queue &q{queues[(tid + k) % n]};
+          std::lock_guard lock(q.mtx);
+          if (q.tasks.empty())
+            continue;
+          if (k == 0)
+            t = q.tasks.back(), q.tasks.pop_back();
+          else
+            t = q.tasks.front(), q.tasks.pop_front();
+          return true;
+        }
+        return false;
+      };
+      Task t;
+      while (pending.load(std::memory_order_acquire) > 0)
+        if (take(t)) {
+          body(t, spawn);
+          pending.fetch_sub(1, std::memory_order_acq_rel);
+        } else
+          std::this_thread::yield();
+    });
+  }
+
+  static ThreadPool &global() {
+    static ThreadPool pool;
+    return pool;
+  }
+};
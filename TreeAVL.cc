@@ -170,6 +170,14 @@ struct AVLTree {
   }
 };
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.map("AVLTree", [] { return std::make_unique<AVLTree<int, int>>(); });
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(100, 999);
@@ -202,3 +210,4 @@ int main() {
     std::print("\n");
   }
 }
+#endif
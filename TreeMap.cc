@@ -321,6 +321,14 @@ template <class K, class V> struct TreeMap {
   }
 };
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  bench.map("TreeMap", [] { return std::make_unique<TreeMap<int, int>>(); });
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(100, 999);
@@ -352,4 +360,5 @@ int main() {
     std::print("{}", TreeMap.isRedBlack(0x80000000, 0x7fffffff));
     std::print("\n");
   }
-}
\ No newline at end of file
+}
+#endif
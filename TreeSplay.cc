@@ -253,6 +253,17 @@ struct SplayTree {
   }
 };
 
+#ifdef BENCH
+#include "Bench.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  // 重复键多时remove退化, 只测小规模
+  bench.map(
+      "SplayTree", [] { return std::make_unique<SplayTree<int, int>>(); },
+      1 << 16);
+}
+#else
 int main() {
   std::mt19937 mt(std::random_device{}());
   std::uniform_int_distribution rand(100, 999);
@@ -294,4 +305,5 @@ int main() {
     std::print("{}", SplayTree.isBST(0x80000000));
     std::print("\n");
   }
-}
\ No newline at end of file
+}
+#endif
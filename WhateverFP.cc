@@ -1,4 +1,7 @@
-#include "Graph.hh"
+#include "CSR.hh"
+#include "ThreadPool.hh"
+#include <atomic>
+#include <cstdint>
 
 // 图可达性
 struct DepthFirstPaths {
@@ -118,6 +121,151 @@ struct BreadthFirstPaths {
   }
 };
 
+// 方向优化bfs
+// 前沿小时自顶向下扩展, 前沿边数超过未探索边数的1/alpha时
+// 改为未访问顶点自底向上在前沿位图中找亲节点
+struct DirectionOptimizingBFS {
+  static constexpr int alpha{14}, beta{24};
+  // 每线程的下一层前沿, 填充避免伪共享
+  struct Local {
+    ns::vector<int> next;
+    char pad[64];
+  };
+  ns::vector<int> edgeTo, distTo;
+  int s;
+
+  DirectionOptimizingBFS(const CSR<Graph> &G, int s,
+                         ThreadPool &pool = ThreadPool::global())
+      : DirectionOptimizingBFS(G, G, s, pool) {}
+  // 自底向上需要入边
+  DirectionOptimizingBFS(const CSR<Digraph> &G, int s,
+                         ThreadPool &pool = ThreadPool::global())
+      : DirectionOptimizingBFS(G, G.reverse(), s, pool) {}
+
+  template <class T>
+  DirectionOptimizingBFS(const T &G, const T &R, int s, ThreadPool &pool)
+      : edgeTo(G.V, -1), distTo(G.V, 0xff), s{s} {
+    assert(0 <= s && s < G.V && R.V == G.V);
+    int V{G.V}, words{(V + 63) / 64};
+    ns::vector<std::uint64_t> front(words, 0), next(words, 0);
+    ns::vector<Local> local(pool.size());
+    ns::vector<int> queue;
+    queue.push_back(s);
+    edgeTo[s] = s, distTo[s] = 0;
+    // scout数邻接表项, unexplored也按邻接表项计, 无向边算两次
+    long unexplored{G.offset[V]}, scout{G.adj[s].size()}, frontier{1};
+    bool bottomUp{false};
+    for (int d = 1; frontier > 0; ++d) {
+      if (!bottomUp && scout > unexplored / alpha) {
+        toBitmap(queue, front, pool);
+        bottomUp = true;
+      } else if (bottomUp && frontier < V / beta) {
+        toQueue(front, queue, local, V, pool);
+        bottomUp = false;
+      }
+      unexplored -= scout;
+      std::atomic<long> count{0}, edges{0};
+      if (bottomUp) {
+        // 各线程只写自己的位图字, 无需原子操作
+        pool.parallelFor(words, 16, [&](long lo, long hi, int) {
+          long cnt{0}, sc{0};
+          for (long k = lo; k < hi; ++k) {
+            std::uint64_t bits{0};
+            for (int v = k * 64, end = std::min<long>(V, v + 64); v < end;
+                 ++v) {
+              if (edgeTo[v] != -1)
+                continue;
+              for (int u : R.adj[v])
+                if (front[u >> 6] >> (u & 63) & 1) {
+                  edgeTo[v] = u, distTo[v] = d;
+                  bits |= std::uint64_t{1} << (v & 63);
+                  ++cnt, sc += G.adj[v].size();
+                  break;
+                }
+            }
+            next[k] = bits;
+          }
+          count += cnt, edges += sc;
+        });
+        std::swap(front, next);
+      } else {
+        pool.parallelFor(queue.size(), 64, [&](long lo, long hi, int tid) {
+          auto &out{local[tid].next};
+          long sc{0};
+          for (long i = lo; i < hi; ++i) {
+            int v{queue[i]};
+            for (int w : G.adj[v]) {
+              std::atomic_ref<int> parent(edgeTo[w]);
+              int expected{-1};
+              if (parent.load(std::memory_order_relaxed) == -1 &&
+                  parent.compare_exchange_strong(expected, v,
+                                                 std::memory_order_relaxed)) {
+                distTo[w] = d;
+                out.push_back(w);
+                sc += G.adj[w].size();
+              }
+            }
+          }
+          edges += sc;
+        });
+        gather(local, queue);
+        count = queue.size();
+      }
+      frontier = count, scout = edges;
+    }
+    edgeTo[s] = -1;
+  }
+
+  static void gather(ns::vector<Local> &local, ns::vector<int> &queue) {
+    int n{0};
+    for (auto &l : local)
+      n += l.next.size();
+    queue = ns::vector<int>(n);
+    n = 0;
+    for (auto &l : local) {
+      std::copy(l.next.begin(), l.next.end(), queue.begin() + n);
+      n += l.next.size();
+      l.next = ns::vector<int>();
+    }
+  }
+
+  static void toBitmap(const ns::vector<int> &queue,
+                       ns::vector<std::uint64_t> &front, ThreadPool &pool) {
+    std::fill(front.begin(), front.end(), 0);
+    pool.parallelFor(queue.size(), 1024, [&](long lo, long hi, int) {
+      for (long i = lo; i < hi; ++i) {
+        int v{queue[i]};
+        std::atomic_ref<std::uint64_t>(front[v >> 6])
+            .fetch_or(std::uint64_t{1} << (v & 63), std::memory_order_relaxed);
+      }
+    });
+  }
+
+  static void toQueue(const ns::vector<std::uint64_t> &front,
+                      ns::vector<int> &queue, ns::vector<Local> &local, int V,
+                      ThreadPool &pool) {
+    pool.parallelFor(front.size(), 64, [&](long lo, long hi, int tid) {
+      auto &out{local[tid].next};
+      for (long k = lo; k < hi; ++k)
+        for (std::uint64_t bits{front[k]}; bits; bits &= bits - 1)
+          if (int v = k * 64 + std::countr_zero(bits); v < V)
+            out.push_back(v);
+    });
+    gather(local, queue);
+  }
+
+  bool hasPathTo(int v) const { return v == s || edgeTo[v] != -1; }
+  ns::deque<int> pathTo(int v) const {
+    ns::deque<int> path;
+    if (hasPathTo(v)) {
+      for (int x = v; x != s; x = edgeTo[x])
+        path.push_front(x);
+      path.push_front(s);
+    }
+    return path;
+  }
+};
+
 template <class P> void printPath(const P &p, int v) {
   for (int i = 0; i < v; ++i) {
     std::print("v{}\t", i);
@@ -131,6 +279,41 @@ template <class P> void printPath(const P &p, int v) {
   }
 }
 
+#ifdef BENCH
+#include "Bench.hh"
+#include "GraphGen.hh"
+
+int main(int argc, char **argv) {
+  Bench bench(argc, argv);
+  for (int n : bench.sizes)
+    for (std::string_view input : bench.graphs) {
+      auto L{generateByName(input, n, bench.seed, false)};
+      if (!L)
+        Bench::usage(argv[0]);
+      Graph G{toGraph<Graph>(*L)};
+      CSR<Graph> csr{toCSR<Graph>(*L)};
+      int s{0};
+      for (int v = 0; v < G.V; ++v)
+        if (csr.adj[v].size() > csr.adj[s].size())
+          s = v;
+      BreadthFirstPaths ref(G, s);
+      auto same = [&](const auto &bfs) {
+        return std::equal(ref.distTo.begin(), ref.distTo.end(),
+                          bfs->distTo.begin(), bfs->distTo.end());
+      };
+      if (bench.selected("bfs", "BreadthFirstPaths"))
+        bench.measure(
+            "bfs", "BreadthFirstPaths", csr.E, input,
+            [] { return std::optional<BreadthFirstPaths>{}; },
+            [&](auto &bfs) { bfs.emplace(G, s); }, same);
+      if (bench.selected("bfs", "DirectionOptimizingBFS"))
+        bench.measure(
+            "bfs", "DirectionOptimizingBFS", csr.E, input,
+            [] { return std::optional<DirectionOptimizingBFS>{}; },
+            [&](auto &bfs) { bfs.emplace(csr, s); }, same);
+    }
+}
+#else
 int main() {
   constexpr int v{8}, e{12};
   Digraph DIG(v);
@@ -154,4 +337,28 @@ int main() {
   for (int v : bfs.distTo)
     std::print("{}\t", v);
   std::print("\n");
+
+  // 与串行bfs比较距离, 亲节点须在上一层且有边相连
+  auto check = [](const auto &G, const auto &bfs, const auto &dobfs) {
+    for (int w = 0; w < G.V; ++w) {
+      assert(bfs.hasPathTo(w) == dobfs.hasPathTo(w));
+      assert(bfs.distTo[w] == dobfs.distTo[w]);
+      if (int v{dobfs.edgeTo[w]}; v != -1) {
+        assert(dobfs.distTo[v] + 1 == dobfs.distTo[w]);
+        assert(std::count(G.adj[v].begin(), G.adj[v].end(), w) == 1);
+      }
+    }
+  };
+  ThreadPool pool(4);
+  for (int k = 0; k < 8; ++k) {
+    Digraph DG(512);
+    generateGraph(DG, 4096);
+    CSR<Digraph> csr(DG);
+    check(DG, BreadthFirstPaths(DG, k), DirectionOptimizingBFS(csr, k, pool));
+    Graph G(512);
+    generateGraph(G, 1024);
+    check(G, BreadthFirstPaths(G, k),
+          DirectionOptimizingBFS(CSR<Graph>(G), k, pool));
+  }
 }
+#endif